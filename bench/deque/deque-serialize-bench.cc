@@ -0,0 +1,52 @@
+// Checkpoint throughput of sjtu::deque::serialize / deserialize against
+// writing and reading the same elements one at a time.
+//
+// build: g++ -std=c++14 -O2 -I include bench/deque/deque-serialize-bench.cc
+// usage: ./a.out [number of elements], which defaults to 2^24
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "deque.hpp"
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+	int n = argc > 1 ? atoi(argv[1]) : 1 << 24;
+	srand(20171103);
+	sjtu::deque<int> d;
+	for (int i = 0; i < n; ++i) {
+		if (rand() % 2) d.push_back(i);
+		else d.push_front(i);
+	}
+	double mb = (double)n * sizeof(int) / (1 << 20);
+
+	std::stringstream one;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (sjtu::deque<int>::const_iterator it = d.cbegin(); it != d.cend(); ++it)
+		one.write(reinterpret_cast<const char *>(&*it), sizeof(int));
+	double write_one = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	sjtu::deque<int> r1;
+	for (int i = 0, x; i < n && one.read(reinterpret_cast<char *>(&x), sizeof(x)); ++i) r1.push_back(x);
+	double read_one = seconds_since(start);
+
+	std::stringstream blocks;
+	start = std::chrono::steady_clock::now();
+	d.serialize(blocks);
+	double write_blocks = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	sjtu::deque<int> r2;
+	r2.deserialize(blocks);
+	double read_blocks = seconds_since(start);
+
+	printf("%d elements (%.0f MB)\n", n, mb);
+	printf("element by element: write %8.1f MB/s, read %8.1f MB/s\n", mb / write_one, mb / read_one);
+	printf("serialize:          write %8.1f MB/s, read %8.1f MB/s\n", mb / write_blocks, mb / read_blocks);
+	return r1.size() == r2.size() ? 0 : 1;
+}
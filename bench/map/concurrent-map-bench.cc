@@ -0,0 +1,106 @@
+// Throughput of sjtu::concurrent_map against a mutex-wrapped sjtu::map
+//   under a read-mostly workload (50 lookups per write).
+//
+// build: g++ -std=c++14 -O2 -pthread -I include bench/map/concurrent-map-bench.cc
+// usage: ./a.out [max threads], which defaults to the number of cores
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "map.hpp"
+#include "concurrent_map.hpp"
+
+const int KEYS = 1 << 20;
+const int OPS_PER_THREAD = 1000000;
+const int READS_PER_WRITE = 50;
+
+// keeps the lookups observable so that they are not optimized away.
+std::atomic<long long> sink(0);
+
+class LockedMap {
+private:
+	sjtu::map<int, int> map;
+	std::mutex lock;
+public:
+	bool insert(int key, int value) {
+		std::lock_guard<std::mutex> guard(lock);
+		return map.insert(sjtu::map<int, int>::value_type(key, value)).second;
+	}
+	bool erase(int key) {
+		std::lock_guard<std::mutex> guard(lock);
+		sjtu::map<int, int>::iterator it = map.find(key);
+		if (it == map.end()) return false;
+		map.erase(it);
+		return true;
+	}
+	bool find(int key, int &value) {
+		std::lock_guard<std::mutex> guard(lock);
+		sjtu::map<int, int>::iterator it = map.find(key);
+		if (it == map.end()) return false;
+		value = it->second;
+		return true;
+	}
+};
+
+class ConcurrentMap {
+private:
+	sjtu::concurrent_map<int, int> map;
+public:
+	bool insert(int key, int value) { return map.insert(sjtu::concurrent_map<int, int>::value_type(key, value)); }
+	bool erase(int key) { return map.erase(key); }
+	bool find(int key, int &value) { return map.find(key, value); }
+};
+
+template<class Map>
+double run(Map &map, int threads) {
+	std::vector<std::thread> workers;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&map, t]() {
+			unsigned long long seed = 88172645463325252ULL + t;
+			long long hits = 0;
+			for (int i = 0; i < OPS_PER_THREAD; i++) {
+				seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+				int key = (int)(seed % (KEYS * 2));
+				if (i % (READS_PER_WRITE + 1) == 0) {
+					if (seed & (1ULL << 40)) map.insert(key, i);
+					else map.erase(key);
+				} else {
+					int value;
+					hits += map.find(key, value);
+				}
+			}
+			sink += hits;
+		}));
+	}
+	for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return threads * (double)OPS_PER_THREAD / elapsed.count() / 1e6;
+}
+
+template<class Map>
+void fill(Map &map) {
+	for (int i = 0; i < KEYS; i++) map.insert(i * 2, i);
+}
+
+int main(int argc, char *argv[]) {
+	int hw = argc > 1 ? atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+	if (hw <= 0) hw = 4;
+	printf("%-8s %18s %18s\n", "threads", "mutex map Mops/s", "concurrent Mops/s");
+	for (int threads = 1; threads <= hw; threads *= 2) {
+		LockedMap locked;
+		ConcurrentMap concurrent;
+		fill(locked);
+		fill(concurrent);
+		double a = run(locked, threads);
+		double b = run(concurrent, threads);
+		printf("%-8d %18.2f %18.2f\n", threads, a, b);
+	}
+	printf("(%lld successful lookups)\n", sink.load());
+	return 0;
+}
@@ -0,0 +1,37 @@
+// Lookup throughput of sjtu::frozen_map against the sjtu::map it was frozen from.
+//
+// build: g++ -std=c++14 -O2 -I include bench/map/frozen-map-bench.cc
+// usage: ./a.out [number of keys], which defaults to 2^20
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "map.hpp"
+#include "frozen_map.hpp"
+
+const int LOOKUPS = 4000000;
+
+template<class Map>
+double run(const Map &m, const std::vector<int> &probes, long long &hits) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < probes.size(); ++i) hits += m.count(probes[i]);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return probes.size() / elapsed.count() / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	srand(20171103);
+	sjtu::map<int, int> m;
+	for (int i = 0; i < keys; ++i) m[rand()] = i;
+	sjtu::frozen_map<int, int> f = m.freeze();
+	std::vector<int> probes(LOOKUPS);
+	for (int i = 0; i < LOOKUPS; ++i) probes[i] = i % 2 ? m.nth(rand() % m.size())->first : rand();
+	long long hits = 0;
+	double tree = run(m, probes, hits);
+	double frozen = run(f, probes, hits);
+	printf("%d keys: map %.2f Mops/s, frozen_map %.2f Mops/s (%lld hits)\n", (int)m.size(), tree, frozen, hits);
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Lookup throughput of sjtu::map::find_batch / count_batch against a loop of find().
+//
+// build: g++ -std=c++14 -O2 -I include bench/map/map-batch-bench.cc
+// usage: ./a.out [number of keys], which defaults to 2^22
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "map.hpp"
+
+typedef sjtu::map<int, int> Map;
+
+const int LOOKUPS = 4000000;
+const int BATCH = 1024;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 22;
+	srand(20171103);
+	Map m;
+	for (int i = 0; i < keys; ++i) m[rand()] = i;
+	std::vector<int> probes(LOOKUPS);
+	for (int i = 0; i < LOOKUPS; ++i) probes[i] = i % 2 ? m.nth(rand() % m.size())->first : rand();
+	std::vector<Map::iterator> found(BATCH);
+	long long hits = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < LOOKUPS; ++i) hits += m.find(probes[i]) != m.end();
+	double single = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < LOOKUPS; i += BATCH) {
+		m.find_batch(probes.begin() + i, probes.begin() + i + BATCH, found.begin());
+		for (int j = 0; j < BATCH; ++j) hits += found[j] != m.end();
+	}
+	double batch = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	hits += m.count_batch(probes.begin(), probes.end());
+	double counted = seconds_since(start);
+
+	printf("%d keys: find %.2f Mops/s, find_batch %.2f Mops/s, count_batch %.2f Mops/s (%lld hits)\n",
+		(int)m.size(), LOOKUPS / single / 1e6, LOOKUPS / batch / 1e6, LOOKUPS / counted / 1e6, hits);
+	return 0;
+}
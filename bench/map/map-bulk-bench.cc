@@ -0,0 +1,51 @@
+// Bulk operations on sjtu::map: range insert and union_with against
+//   element-by-element insert and merge.
+//
+// build: g++ -std=c++14 -O2 -pthread -I include bench/map/map-bulk-bench.cc
+// usage: ./a.out [number of keys per map], which defaults to 2^21
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "map.hpp"
+
+typedef sjtu::map<int, int> Map;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 21;
+	srand(20171103);
+	std::vector<Map::value_type> a, b;
+	for (int i = 0; i < keys; ++i) {
+		a.push_back(Map::value_type(rand(), i));
+		b.push_back(Map::value_type(rand(), -i));
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Map x, y;
+	for (size_t i = 0; i < a.size(); ++i) x.insert(a[i]);
+	for (size_t i = 0; i < b.size(); ++i) y.insert(b[i]);
+	double single_build = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	x.merge(y);
+	double merge = seconds_since(start);
+
+	start = std::chrono::steady_clock::now();
+	Map p, q;
+	p.insert(a.begin(), a.end());
+	q.insert(b.begin(), b.end());
+	double bulk_build = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	p.union_with(std::move(q));
+	double unite = seconds_since(start);
+
+	printf("%d + %d keys, %u threads: insert loop %.2fs, range insert %.2fs; merge %.2fs, union_with %.2fs (%d, %d)\n",
+		keys, keys, std::thread::hardware_concurrency(), single_build, bulk_build, merge, unite, (int)x.size(), (int)p.size());
+	return 0;
+}
@@ -0,0 +1,61 @@
+// Lookup throughput of sjtu::map on a skewed (Zipf) key distribution,
+// with and without the hot key cache.
+//
+// build: g++ -std=c++14 -O2 -I include bench/map/map-hot-bench.cc
+// usage: ./a.out [number of keys] [zipf exponent], which default to 2^20 and 1.1
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "map.hpp"
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+// probes drawn by inverting the Zipf cdf; the ranks are scattered over the keys.
+std::vector<int> zipf_probes(int keys, double alpha, size_t n) {
+	std::vector<double> cdf(keys);
+	double total = 0;
+	for (int i = 0; i < keys; ++i) cdf[i] = total += 1 / pow(i + 1.0, alpha);
+	std::vector<int> key_of_rank(keys);
+	for (int i = 0; i < keys; ++i) key_of_rank[i] = 3 * i;
+	std::random_shuffle(key_of_rank.begin(), key_of_rank.end());
+	std::vector<int> probes(n);
+	for (size_t i = 0; i < n; ++i) {
+		double u = (double)rand() / RAND_MAX * total;
+		probes[i] = key_of_rank[std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()];
+	}
+	return probes;
+}
+
+void run(const char *name, int keys, size_t slots, const std::vector<int> &probes) {
+	sjtu::map<int, int> m;
+	for (int i = 0; i < keys; ++i) m[3 * i] = i;
+	if (slots) m.set_hot_cache(slots);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	long long sum = 0;
+	for (size_t i = 0; i < probes.size(); ++i) sum += m.at(probes[i]);
+	double at = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < probes.size(); ++i) ++m[probes[i]];
+	double bump = seconds_since(start);
+	printf("%-16s at %7.2f  operator[] %7.2f Mops/s  (%lld)\n", name,
+		probes.size() / at / 1e6, probes.size() / bump / 1e6, sum);
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	double alpha = argc > 2 ? atof(argv[2]) : 1.1;
+	srand(20171103);
+	std::vector<int> probes = zipf_probes(keys, alpha, 4000000);
+	run("map", keys, 0, probes);
+	run("map, 256 slots", keys, 256, probes);
+	run("map, 4096 slots", keys, 4096, probes);
+	return 0;
+}
@@ -0,0 +1,60 @@
+// Lookup and insert throughput of sjtu::map for long long and std::string keys,
+// under std::less (the specialized descents) and under an equivalent
+// comparator of our own, which takes the generic path.
+//
+// build: g++ -std=c++14 -O2 -I include bench/map/map-key-bench.cc
+// usage: ./a.out [number of keys], which defaults to 2^20
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "map.hpp"
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template<class Key>
+struct generic_less {
+	bool operator()(const Key &a, const Key &b) const { return a < b; }
+};
+
+// keys sharing a short common head, as URLs or paths do.
+std::string string_key(long long i) {
+	char buf[32];
+	sprintf(buf, "key/%012lld", i * 2654435761LL % 1000000007LL);
+	return buf;
+}
+long long make_key(long long i, long long *) { return i * 2654435761LL % 1000000007LL; }
+std::string make_key(long long i, std::string *) { return string_key(i); }
+
+template<class Key, class Compare>
+void run(const char *name, int keys) {
+	srand(20171103);
+	std::vector<Key> in(keys), probes(1000000);
+	for (int i = 0; i < keys; ++i) in[i] = make_key(i, (Key *)nullptr);
+	for (size_t i = 0; i < probes.size(); ++i) probes[i] = make_key(rand() % (2 * keys), (Key *)nullptr);
+	sjtu::map<Key, int, Compare> m;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < keys; ++i) m[in[i]] = i;
+	double insert = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	long long hits = 0;
+	for (size_t i = 0; i < probes.size(); ++i) hits += m.count(probes[i]);
+	double lookup = seconds_since(start);
+	printf("%-22s operator[] %6.2f  count %6.2f Mops/s  (%lld)\n", name,
+		keys / insert / 1e6, probes.size() / lookup / 1e6, hits);
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	run<long long, std::less<long long> >("long long, std::less", keys);
+	run<long long, generic_less<long long> >("long long, generic", keys);
+	run<std::string, std::less<std::string> >("string, std::less", keys);
+	run<std::string, generic_less<std::string> >("string, generic", keys);
+	return 0;
+}
@@ -0,0 +1,46 @@
+// Append, iteration and random lookup throughput of sjtu::skiplist_map
+// against sjtu::map.
+//
+// build: g++ -std=c++14 -O2 -I include bench/map/skiplist-map-bench.cc
+// usage: ./a.out [number of keys], which defaults to 2^20
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "map.hpp"
+#include "skiplist_map.hpp"
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+template<class Map>
+void run(const char *name, int keys, const std::vector<int> &probes) {
+	Map m;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < keys; ++i) m[3 * i] = i;
+	double append = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	long long sum = 0;
+	for (typename Map::const_iterator it = m.cbegin(); it != m.cend(); ++it) sum += it->second;
+	double iterate = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	long long hits = 0;
+	for (size_t i = 0; i < probes.size(); ++i) hits += m.count(probes[i]);
+	double lookup = seconds_since(start);
+	printf("%-13s append %7.2f  iterate %8.2f  count %6.2f Mops/s  (%lld %lld)\n", name,
+		keys / append / 1e6, keys / iterate / 1e6, probes.size() / lookup / 1e6, sum, hits);
+}
+
+int main(int argc, char *argv[]) {
+	int keys = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	srand(20171103);
+	std::vector<int> probes(1000000);
+	for (size_t i = 0; i < probes.size(); ++i) probes[i] = rand() % (3 * keys);
+	run<sjtu::map<int, int> >("map", keys, probes);
+	run<sjtu::skiplist_map<int, int> >("skiplist_map", keys, probes);
+	return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef SJTU_CLASS_COUNTED_INTEGER_HPP
+#define SJTU_CLASS_COUNTED_INTEGER_HPP
+
+/**
+ * counter lives in a class template so that its definition can sit in this
+ *   header without clashing when several translation units include it.
+ */
+template <class Tag>
+struct live_counter {
+	static int counter;
+};
+template <class Tag>
+int live_counter<Tag>::counter = 0;
+
+/**
+ * a key for the container tests: it has no default constructor and no
+ *   assignment, and counter tracks how many copies are alive, so a test
+ *   can check that every element it put in was destroyed again.
+ */
+class Integer : public live_counter<Integer> {
+public:
+	int val;
+	Integer(int val) : val(val) { counter++; }
+	Integer(const Integer &rhs) : val(rhs.val) { counter++; }
+	Integer & operator = (const Integer &) = delete;
+	~Integer() { counter--; }
+};
+
+struct Compare {
+	bool operator () (const Integer &lhs, const Integer &rhs) const { return lhs.val < rhs.val; }
+};
+
+#endif
@@ -0,0 +1,610 @@
+/**
+ * a variant of sjtu::map with 32-bit node links, for very large maps of small elements
+ */
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a red-black tree whose nodes live in an arena owned by the map and refer
+ *   to each other by 32-bit indices instead of pointers.
+ * a node is two child indices and one word holding the parent index shifted
+ *   left by one, with the color in the lowest bit: 12 bytes of links, where
+ *   sjtu::map spends 32 (three pointers and a subtree size). a node of
+ *   compact_map<int, int> is 20 bytes against 40.
+ * the price is the order statistics of sjtu::map (no subtree sizes), and a
+ *   limit of 2^31 - 1 elements, past which insert throws runtime_error.
+ *
+ * this is its own tree, not rb_tree.hpp with another node layout: rb_tree
+ *   links nodes by pointer and keeps sizes, augment summaries and key
+ *   caches in them, which is the space this class exists to save. so only
+ *   the basic map interface is here. there is no nth() or rank(), the
+ *   iterators are bidirectional only (no it + n, it - n or it1 - it2), and
+ *   none of bounds, range erase, merge, extract, set operations, lazy
+ *   erase, the hot key cache or aggregate() are provided.
+ *
+ * the arena is a fixed table of chunks of 16, 16, 32, 64, ... nodes, so the
+ *   chunk of an index is found with one count-leading-zeros, and nodes never
+ *   move: references to elements stay valid until they are erased.
+ *   erased nodes are kept on a free list, linked through their left index.
+ * index 0 is the nil sentinel (always black), which lets the rebalancing
+ *   code follow the textbook without null checks.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class compact_map {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	typedef uint32_t index;
+	struct node {
+		index left, right;
+		index parent_red;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+		value_type *valptr() { return reinterpret_cast<value_type *>(storage); }
+		const value_type *valptr() const { return reinterpret_cast<const value_type *>(storage); }
+	};
+
+	static const index nil = 0;
+	static const int first_chunk_bits = 4;
+	static const int max_chunks = 32 - first_chunk_bits + 1;
+	static const index max_index = 0x7fffffff;
+
+	node *chunks[max_chunks];
+	index next_fresh, free_list;
+	index root, leftmost, rightmost;
+	size_t num;
+	Compare cmp;
+
+	/**
+	 * chunk 0 holds indices [0, 16) and chunk c >= 1 holds [2^(c+3), 2^(c+4)).
+	 */
+	static int chunk_of(index i) {
+		if (i < ((index)1 << first_chunk_bits)) return 0;
+#ifdef __GNUC__
+		int log = 31 - __builtin_clz(i);
+#else
+		int log = 0;
+		while (i >> (log + 1)) ++log;
+#endif
+		return log - first_chunk_bits + 1;
+	}
+	static index chunk_begin(int c) {
+		return c ? (index)1 << (c + first_chunk_bits - 1) : 0;
+	}
+	static index chunk_length(int c) {
+		return (index)1 << (c ? c + first_chunk_bits - 1 : first_chunk_bits);
+	}
+	node &slot(index i) {
+		int c = chunk_of(i);
+		return chunks[c][i - chunk_begin(c)];
+	}
+	const node &slot(index i) const {
+		int c = chunk_of(i);
+		return chunks[c][i - chunk_begin(c)];
+	}
+	index &left(index i) { return slot(i).left; }
+	index left(index i) const { return slot(i).left; }
+	index &right(index i) { return slot(i).right; }
+	index right(index i) const { return slot(i).right; }
+	index parent(index i) const { return slot(i).parent_red >> 1; }
+	void set_parent(index i, index p) {
+		node &n = slot(i);
+		n.parent_red = (p << 1) | (n.parent_red & 1);
+	}
+	bool red(index i) const { return slot(i).parent_red & 1; }
+	void set_red(index i, bool r) {
+		node &n = slot(i);
+		n.parent_red = (n.parent_red & ~(index)1) | (index)r;
+	}
+	const Key &key(index i) const { return slot(i).valptr()->first; }
+
+	void add_chunk(int c) {
+		chunks[c] = static_cast<node *>(::operator new(chunk_length(c) * sizeof(node)));
+		if (c == 0) {
+			node &n = chunks[0][nil];
+			n.left = n.right = nil;
+			n.parent_red = 0;
+		}
+	}
+	index allocate_slot() {
+		if (free_list != nil) {
+			index i = free_list;
+			free_list = left(i);
+			return i;
+		}
+		if (next_fresh == max_index) throw runtime_error();
+		int c = chunk_of(next_fresh);
+		if (!chunks[c]) add_chunk(c);
+		return next_fresh++;
+	}
+	void release_slot(index i) {
+		left(i) = free_list;
+		free_list = i;
+	}
+	template<class... Args>
+	index create_node(Args &&... args) {
+		index i = allocate_slot();
+		try {
+			new (slot(i).storage) value_type(std::forward<Args>(args)...);
+		} catch (...) {
+			release_slot(i);
+			throw;
+		}
+		return i;
+	}
+	void destroy_values() {
+		for (index i = leftmost; i != nil; ) {
+			index next = successor(i);
+			slot(i).valptr()->~value_type();
+			i = next;
+		}
+	}
+	void release_chunks() {
+		for (int c = 0; c < max_chunks; ++c) {
+			::operator delete(chunks[c]);
+			chunks[c] = nullptr;
+		}
+	}
+	void reset() {
+		next_fresh = 1;
+		free_list = root = leftmost = rightmost = nil;
+		num = 0;
+	}
+
+	index minimum(index i) const {
+		while (left(i) != nil) i = left(i);
+		return i;
+	}
+	index maximum(index i) const {
+		while (right(i) != nil) i = right(i);
+		return i;
+	}
+	index successor(index i) const {
+		if (right(i) != nil) return minimum(right(i));
+		index q = parent(i);
+		while (q != nil && i == right(q)) {
+			i = q;
+			q = parent(q);
+		}
+		return q;
+	}
+	index predecessor(index i) const {
+		if (left(i) != nil) return maximum(left(i));
+		index q = parent(i);
+		while (q != nil && i == left(q)) {
+			i = q;
+			q = parent(q);
+		}
+		return q;
+	}
+	void rotate_left(index x) {
+		index y = right(x);
+		right(x) = left(y);
+		if (left(y) != nil) set_parent(left(y), x);
+		set_parent(y, parent(x));
+		if (parent(x) == nil) root = y;
+		else if (x == left(parent(x))) left(parent(x)) = y;
+		else right(parent(x)) = y;
+		left(y) = x;
+		set_parent(x, y);
+	}
+	void rotate_right(index x) {
+		index y = left(x);
+		left(x) = right(y);
+		if (right(y) != nil) set_parent(right(y), x);
+		set_parent(y, parent(x));
+		if (parent(x) == nil) root = y;
+		else if (x == right(parent(x))) right(parent(x)) = y;
+		else left(parent(x)) = y;
+		right(y) = x;
+		set_parent(x, y);
+	}
+	void insert_fixup(index z) {
+		while (red(parent(z))) {
+			index p = parent(z), g = parent(p);
+			if (p == left(g)) {
+				index u = right(g);
+				if (red(u)) {
+					set_red(p, false);
+					set_red(u, false);
+					set_red(g, true);
+					z = g;
+				} else {
+					if (z == right(p)) {
+						z = p;
+						rotate_left(z);
+						p = parent(z);
+					}
+					set_red(p, false);
+					set_red(g, true);
+					rotate_right(g);
+				}
+			} else {
+				index u = left(g);
+				if (red(u)) {
+					set_red(p, false);
+					set_red(u, false);
+					set_red(g, true);
+					z = g;
+				} else {
+					if (z == left(p)) {
+						z = p;
+						rotate_right(z);
+						p = parent(z);
+					}
+					set_red(p, false);
+					set_red(g, true);
+					rotate_left(g);
+				}
+			}
+		}
+		set_red(root, false);
+	}
+	/**
+	 * x may be nil here; its parent is then the one transplant() left in nil.
+	 */
+	void erase_fixup(index x) {
+		while (x != root && !red(x)) {
+			index p = parent(x);
+			if (x == left(p)) {
+				index w = right(p);
+				if (red(w)) {
+					set_red(w, false);
+					set_red(p, true);
+					rotate_left(p);
+					w = right(p);
+				}
+				if (!red(left(w)) && !red(right(w))) {
+					set_red(w, true);
+					x = p;
+				} else {
+					if (!red(right(w))) {
+						set_red(left(w), false);
+						set_red(w, true);
+						rotate_right(w);
+						w = right(p);
+					}
+					set_red(w, red(p));
+					set_red(p, false);
+					set_red(right(w), false);
+					rotate_left(p);
+					x = root;
+				}
+			} else {
+				index w = left(p);
+				if (red(w)) {
+					set_red(w, false);
+					set_red(p, true);
+					rotate_right(p);
+					w = left(p);
+				}
+				if (!red(left(w)) && !red(right(w))) {
+					set_red(w, true);
+					x = p;
+				} else {
+					if (!red(left(w))) {
+						set_red(right(w), false);
+						set_red(w, true);
+						rotate_left(w);
+						w = left(p);
+					}
+					set_red(w, red(p));
+					set_red(p, false);
+					set_red(left(w), false);
+					rotate_right(p);
+					x = root;
+				}
+			}
+		}
+		set_red(x, false);
+	}
+	void transplant(index u, index v) {
+		if (parent(u) == nil) root = v;
+		else if (u == left(parent(u))) left(parent(u)) = v;
+		else right(parent(u)) = v;
+		set_parent(v, parent(u));
+	}
+	void erase_node(index z) {
+		if (z == leftmost) leftmost = successor(z);
+		if (z == rightmost) rightmost = predecessor(z);
+		index y = z, x;
+		bool removed_red = red(y);
+		if (left(z) == nil) {
+			x = right(z);
+			transplant(z, x);
+		} else if (right(z) == nil) {
+			x = left(z);
+			transplant(z, x);
+		} else {
+			y = minimum(right(z));
+			removed_red = red(y);
+			x = right(y);
+			if (parent(y) == z) {
+				set_parent(x, y);
+			} else {
+				transplant(y, x);
+				right(y) = right(z);
+				set_parent(right(y), y);
+			}
+			transplant(z, y);
+			left(y) = left(z);
+			set_parent(left(y), y);
+			set_red(y, red(z));
+		}
+		if (!removed_red) erase_fixup(x);
+		slot(z).valptr()->~value_type();
+		release_slot(z);
+		--num;
+	}
+	index find_index(const Key &k) const {
+		index p = root;
+		while (p != nil) {
+			if (cmp(k, key(p))) p = left(p);
+			else if (cmp(key(p), k)) p = right(p);
+			else return p;
+		}
+		return nil;
+	}
+	/**
+	 * insert a node built from args unless key is present.
+	 * returns the node with key, and whether it is new.
+	 */
+	template<class... Args>
+	pair<index, bool> insert_node(const Key &k, Args &&... args) {
+		index y = nil, x = root;
+		bool goes_left = true;
+		while (x != nil) {
+			y = x;
+			if (cmp(k, key(x))) {
+				goes_left = true;
+				x = left(x);
+			} else if (cmp(key(x), k)) {
+				goes_left = false;
+				x = right(x);
+			} else {
+				return pair<index, bool>(x, false);
+			}
+		}
+		index z = create_node(std::forward<Args>(args)...);
+		node &n = slot(z);
+		n.left = n.right = nil;
+		n.parent_red = (y << 1) | 1;
+		if (y == nil) root = leftmost = rightmost = z;
+		else if (goes_left) left(y) = z;
+		else right(y) = z;
+		if (y == leftmost && goes_left) leftmost = z;
+		if (y == rightmost && !goes_left) rightmost = z;
+		insert_fixup(z);
+		++num;
+		return pair<index, bool>(z, true);
+	}
+public:
+	/**
+	 * a bidirectional iterator; the nil index stands for end().
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 *     like it = map.begin(); --it;
+	 *       or it = map.end(); ++end();
+	 */
+	class const_iterator;
+	class iterator {
+		friend class compact_map;
+		friend class const_iterator;
+	private:
+		compact_map *owner;
+		index i;
+		iterator(compact_map *owner, index i) : owner(owner), i(i) {}
+	public:
+		iterator() : owner(nullptr), i(nil) {}
+		iterator(const iterator &other) : owner(other.owner), i(other.i) {}
+		iterator & operator=(const iterator &other) = default;
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		iterator & operator++() {
+			if (!owner || i == nil) throw invalid_iterator();
+			i = owner->successor(i);
+			return *this;
+		}
+		iterator operator--(int) {
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		iterator & operator--() {
+			if (!owner || i == owner->leftmost) throw invalid_iterator();
+			i = i != nil ? owner->predecessor(i) : owner->rightmost;
+			return *this;
+		}
+		value_type & operator*() const {
+			if (!owner || i == nil) throw invalid_iterator();
+			return *owner->slot(i).valptr();
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && i == rhs.i; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && i == rhs.i; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+		value_type* operator->() const noexcept { return owner->slot(i).valptr(); }
+	};
+	class const_iterator {
+		friend class compact_map;
+		friend class iterator;
+		private:
+			const compact_map *owner;
+			index i;
+			const_iterator(const compact_map *owner, index i) : owner(owner), i(i) {}
+		public:
+			const_iterator() : owner(nullptr), i(nil) {}
+			const_iterator(const const_iterator &other) : owner(other.owner), i(other.i) {}
+			const_iterator(const iterator &other) : owner(other.owner), i(other.i) {}
+			const_iterator & operator=(const const_iterator &other) = default;
+			const_iterator operator++(int) {
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (!owner || i == nil) throw invalid_iterator();
+				i = owner->successor(i);
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				if (!owner || i == owner->leftmost) throw invalid_iterator();
+				i = i != nil ? owner->predecessor(i) : owner->rightmost;
+				return *this;
+			}
+			const value_type & operator*() const {
+				if (!owner || i == nil) throw invalid_iterator();
+				return *owner->slot(i).valptr();
+			}
+			bool operator==(const iterator &rhs) const { return owner == rhs.owner && i == rhs.i; }
+			bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && i == rhs.i; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+			const value_type* operator->() const noexcept { return owner->slot(i).valptr(); }
+	};
+
+	compact_map() {
+		for (int c = 0; c < max_chunks; ++c) chunks[c] = nullptr;
+		reset();
+	}
+	/**
+	 * the copy reuses the indices of other, so its links are copied as they are
+	 *   and only the values are constructed one by one.
+	 */
+	compact_map(const compact_map &other) : cmp(other.cmp) {
+		for (int c = 0; c < max_chunks; ++c) chunks[c] = nullptr;
+		reset();
+		if (!other.num) return;
+		size_t built = 0;
+		try {
+			for (int c = 0; c <= chunk_of(other.next_fresh - 1); ++c) add_chunk(c);
+			for (index i = 0; i < other.next_fresh; ++i) {
+				node &n = slot(i);
+				const node &o = other.slot(i);
+				n.left = o.left;
+				n.right = o.right;
+				n.parent_red = o.parent_red;
+			}
+			for (index i = other.leftmost; i != nil; i = other.successor(i), ++built)
+				new (slot(i).storage) value_type(*other.slot(i).valptr());
+		} catch (...) {
+			for (index i = other.leftmost; built > 0; i = other.successor(i), --built)
+				slot(i).valptr()->~value_type();
+			release_chunks();
+			throw;
+		}
+		next_fresh = other.next_fresh;
+		free_list = other.free_list;
+		root = other.root;
+		leftmost = other.leftmost;
+		rightmost = other.rightmost;
+		num = other.num;
+	}
+	compact_map & operator=(const compact_map &other) {
+		if (this == &other) return *this;
+		compact_map tmp(other);
+		for (int c = 0; c < max_chunks; ++c) std::swap(chunks[c], tmp.chunks[c]);
+		std::swap(next_fresh, tmp.next_fresh);
+		std::swap(free_list, tmp.free_list);
+		std::swap(root, tmp.root);
+		std::swap(leftmost, tmp.leftmost);
+		std::swap(rightmost, tmp.rightmost);
+		std::swap(num, tmp.num);
+		std::swap(cmp, tmp.cmp);
+		return *this;
+	}
+	~compact_map() {
+		destroy_values();
+		release_chunks();
+	}
+	/**
+	 * access specified element with bounds checking.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	T & at(const Key &key) {
+		index i = find_index(key);
+		if (i == nil) throw index_out_of_bound();
+		return slot(i).valptr()->second;
+	}
+	const T & at(const Key &key) const {
+		index i = find_index(key);
+		if (i == nil) throw index_out_of_bound();
+		return slot(i).valptr()->second;
+	}
+	/**
+	 * access specified element, performing an insertion if such key does not already exist.
+	 */
+	T & operator[](const Key &key) {
+		return slot(insert_node(key, key, T()).first).valptr()->second;
+	}
+	/**
+	 * behave like at() throw index_out_of_bound if such key does not exist.
+	 */
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	iterator begin() { return iterator(this, leftmost); }
+	const_iterator cbegin() const { return const_iterator(this, leftmost); }
+	iterator end() { return iterator(this, nil); }
+	const_iterator cend() const { return const_iterator(this, nil); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	/**
+	 * the largest number of elements the 31-bit parent links can address.
+	 */
+	size_t max_size() const { return max_index - 1; }
+	/**
+	 * clears the contents; the arena is kept for reuse.
+	 */
+	void clear() {
+		destroy_values();
+		reset();
+	}
+	/**
+	 * insert an element.
+	 * return a pair, the first of the pair is
+	 *   the iterator to the new element (or the element that prevented the insertion),
+	 *   the second one is true if insert successfully, or false.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		pair<index, bool> r = insert_node(value.first, value);
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
+	/**
+	 * erase the element at pos.
+	 *
+	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 */
+	void erase(iterator pos) {
+		if (pos.owner != this || pos.i == nil) throw invalid_iterator();
+		erase_node(pos.i);
+	}
+	size_t count(const Key &key) const { return find_index(key) != nil ? 1 : 0; }
+	iterator find(const Key &key) { return iterator(this, find_index(key)); }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_index(key)); }
+};
+
+}
+
+#endif
@@ -0,0 +1,353 @@
+/**
+ * an ordered map which can be shared by many threads without a global lock
+ */
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <atomic>
+#include <thread>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a lazy skip list (Herlihy, Lev, Luchangco and Shavit).
+ *
+ * find() and count() take no lock and never write to shared nodes:
+ *   they walk the towers and check the marked / fully_linked flags.
+ * insert() and erase() lock only the predecessors of the affected tower,
+ *   validate them, and retry if another writer got there first.
+ *
+ * erased nodes are reclaimed with epochs: every operation registers in a
+ *   per-thread reader slot, and a retired node is freed once no operation
+ *   that could still see it is running. the slots live on separate cache
+ *   lines, so readers on different cores do not contend, and retiring a
+ *   node is a push onto a lock-free list, so erasers do not either.
+ *
+ * values are handed out by copy, since an element may be erased by
+ *   another thread as soon as the lookup returns.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class concurrent_map {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	static const int max_level = 20;
+	static const int reader_slots = 16;
+	static const int reclaim_period = 64;
+
+	class spinlock {
+	private:
+		std::atomic<bool> flag;
+	public:
+		spinlock() : flag(false) {}
+		void lock() {
+			while (flag.exchange(true, std::memory_order_acquire))
+				while (flag.load(std::memory_order_relaxed)) std::this_thread::yield();
+		}
+		void unlock() { flag.store(false, std::memory_order_release); }
+	};
+	/**
+	 * a node and its tower of next pointers are allocated as one block,
+	 *   with the level-i link stored right after the node at next()[i].
+	 * the head sentinel carries no value; null stands for +infinity.
+	 */
+	struct node {
+		node *retired_next;
+		int top;
+		std::atomic<bool> marked, fully_linked;
+		spinlock lock;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+		value_type *valptr() { return reinterpret_cast<value_type *>(storage); }
+		const Key &key() { return valptr()->first; }
+		std::atomic<node *> *next() { return reinterpret_cast<std::atomic<node *> *>(this + 1); }
+	};
+	struct alignas(64) reader_slot {
+		std::atomic<size_t> active[2];
+		reader_slot() { active[0] = active[1] = 0; }
+	};
+
+	node *head;
+	Compare cmp;
+	std::atomic<size_t> num;
+	std::atomic<size_t> epoch;
+	mutable reader_slot slots[reader_slots];
+	std::atomic<node *> retired[2];
+	std::atomic<size_t> retired_since;
+	std::atomic<bool> reclaiming;
+
+	static node *allocate_node(int top) {
+		void *raw = ::operator new(sizeof(node) + (top + 1) * sizeof(std::atomic<node *>));
+		node *p = static_cast<node *>(raw);
+		p->retired_next = nullptr;
+		p->top = top;
+		new (&p->marked) std::atomic<bool>(false);
+		new (&p->fully_linked) std::atomic<bool>(false);
+		new (&p->lock) spinlock();
+		for (int i = 0; i <= top; ++i) new (p->next() + i) std::atomic<node *>(nullptr);
+		return p;
+	}
+	static void destroy_node(node *p) {
+		p->valptr()->~value_type();
+		::operator delete(p);
+	}
+	static void destroy_list(node *p) {
+		while (p) {
+			node *q = p->retired_next;
+			destroy_node(p);
+			p = q;
+		}
+	}
+	static int random_level() {
+		static thread_local unsigned long long seed =
+			std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		// each level is kept with probability 1/4.
+		int level = 0;
+		for (unsigned long long bits = seed; level < max_level - 1 && (bits & 3) == 0; bits >>= 2) ++level;
+		return level;
+	}
+	static reader_slot &my_slot(reader_slot *slots) {
+		static std::atomic<unsigned> next_slot(0);
+		static thread_local unsigned slot = next_slot.fetch_add(1) % reader_slots;
+		return slots[slot];
+	}
+	/**
+	 * keeps the nodes seen by one operation alive until it finishes.
+	 */
+	class epoch_guard {
+	private:
+		std::atomic<size_t> &counter;
+		static std::atomic<size_t> &enter(const concurrent_map *m) {
+			reader_slot &slot = my_slot(m->slots);
+			for (;;) {
+				size_t e = m->epoch.load();
+				slot.active[e & 1].fetch_add(1);
+				if (m->epoch.load() == e) return slot.active[e & 1];
+				slot.active[e & 1].fetch_sub(1);
+			}
+		}
+	public:
+		explicit epoch_guard(const concurrent_map *m) : counter(enter(m)) {}
+		~epoch_guard() { counter.fetch_sub(1, std::memory_order_release); }
+	};
+	/**
+	 * hand over a node which is no longer reachable from head.
+	 * it is pushed onto the list of the current epoch. every reclaim_period
+	 *   retirements, one thread advances the epoch if no reader of the
+	 *   previous epoch is left and takes the nodes of that epoch, which it
+	 *   destroys after letting go, so no user destructor runs under the flag.
+	 * a push which read an epoch that has moved on since only frees the node
+	 *   later: it was unlinked no later than the epoch that was read.
+	 */
+	void retire(node *p) {
+		std::atomic<node *> &list = retired[epoch.load() & 1];
+		node *top = list.load();
+		do {
+			p->retired_next = top;
+		} while (!list.compare_exchange_weak(top, p));
+		if ((retired_since.fetch_add(1) + 1) % reclaim_period != 0) return;
+		if (reclaiming.exchange(true)) return;
+		size_t e = epoch.load(), old = (e + 1) & 1;
+		bool quiet = true;
+		for (int i = 0; quiet && i < reader_slots; ++i) quiet = slots[i].active[old].load() == 0;
+		node *done = nullptr;
+		if (quiet) {
+			done = retired[old].exchange(nullptr);
+			epoch.store(e + 1);
+		}
+		reclaiming.store(false);
+		destroy_list(done);
+	}
+	/**
+	 * fill in the predecessors and successors of key on every level.
+	 * returns the highest level on which key was found, or -1.
+	 */
+	int find_position(const Key &key, node **preds, node **succs) const {
+		int found = -1;
+		node *pred = head;
+		for (int level = max_level - 1; level >= 0; --level) {
+			node *curr = pred->next()[level].load(std::memory_order_acquire);
+			while (curr && cmp(curr->key(), key)) {
+				pred = curr;
+				curr = pred->next()[level].load(std::memory_order_acquire);
+			}
+			if (found == -1 && curr && !cmp(key, curr->key())) found = level;
+			preds[level] = pred;
+			succs[level] = curr;
+		}
+		return found;
+	}
+	/**
+	 * lock the distinct predecessors on levels [0, top].
+	 */
+	static void lock_preds(node **preds, int top) {
+		for (int level = 0; level <= top; ++level)
+			if (level == 0 || preds[level] != preds[level - 1]) preds[level]->lock.lock();
+	}
+	static void unlock_preds(node **preds, int top) {
+		for (int level = 0; level <= top; ++level)
+			if (level == 0 || preds[level] != preds[level - 1]) preds[level]->lock.unlock();
+	}
+	/**
+	 * the live node with key, or null; the caller must hold an epoch_guard.
+	 */
+	node *find_node(const Key &key) const {
+		node *preds[max_level], *succs[max_level];
+		int found = find_position(key, preds, succs);
+		if (found == -1) return nullptr;
+		node *p = succs[found];
+		if (!p->fully_linked.load(std::memory_order_acquire) || p->marked.load(std::memory_order_acquire)) return nullptr;
+		return p;
+	}
+public:
+	concurrent_map() : head(allocate_node(max_level - 1)), num(0), epoch(0), retired_since(0), reclaiming(false) {
+		retired[0] = retired[1] = nullptr;
+	}
+	concurrent_map(const concurrent_map &) = delete;
+	concurrent_map & operator=(const concurrent_map &) = delete;
+	/**
+	 * must not run concurrently with any other operation.
+	 */
+	~concurrent_map() {
+		node *p = head->next()[0].load();
+		while (p) {
+			node *q = p->next()[0].load();
+			destroy_node(p);
+			p = q;
+		}
+		::operator delete(head);
+		destroy_list(retired[0].load());
+		destroy_list(retired[1].load());
+	}
+	/**
+	 * the number of elements; exact only when no writer is running.
+	 */
+	size_t size() const { return num.load(std::memory_order_relaxed); }
+	bool empty() const { return size() == 0; }
+	/**
+	 * insert value if its key is not present yet.
+	 * returns true if the insertion took place.
+	 */
+	bool insert(const value_type &value) {
+		epoch_guard guard(this);
+		int top = random_level();
+		node *preds[max_level], *succs[max_level];
+		for (;;) {
+			int found = find_position(value.first, preds, succs);
+			if (found != -1) {
+				node *p = succs[found];
+				if (!p->marked.load(std::memory_order_acquire)) {
+					while (!p->fully_linked.load(std::memory_order_acquire)) std::this_thread::yield();
+					return false;
+				}
+				continue;
+			}
+			lock_preds(preds, top);
+			bool valid = true;
+			for (int level = 0; valid && level <= top; ++level) {
+				node *pred = preds[level], *succ = succs[level];
+				valid = !pred->marked.load() && (!succ || !succ->marked.load())
+					&& pred->next()[level].load() == succ;
+			}
+			if (!valid) {
+				unlock_preds(preds, top);
+				continue;
+			}
+			node *p = allocate_node(top);
+			try {
+				new (p->storage) value_type(value);
+			} catch (...) {
+				::operator delete(p);
+				unlock_preds(preds, top);
+				throw;
+			}
+			for (int level = 0; level <= top; ++level) p->next()[level].store(succs[level], std::memory_order_relaxed);
+			for (int level = 0; level <= top; ++level) preds[level]->next()[level].store(p, std::memory_order_release);
+			p->fully_linked.store(true, std::memory_order_release);
+			unlock_preds(preds, top);
+			num.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	/**
+	 * erase the element with key.
+	 * returns true if this call removed it.
+	 */
+	bool erase(const Key &key) {
+		epoch_guard guard(this);
+		node *victim = nullptr;
+		int top = -1;
+		node *preds[max_level], *succs[max_level];
+		for (;;) {
+			int found = find_position(key, preds, succs);
+			if (!victim) {
+				if (found == -1) return false;
+				node *p = succs[found];
+				if (!p->fully_linked.load(std::memory_order_acquire) || p->top != found || p->marked.load()) return false;
+				victim = p;
+				top = victim->top;
+				victim->lock.lock();
+				if (victim->marked.load()) {
+					victim->lock.unlock();
+					return false;
+				}
+				victim->marked.store(true, std::memory_order_release);
+			}
+			lock_preds(preds, top);
+			bool valid = true;
+			for (int level = 0; valid && level <= top; ++level)
+				valid = !preds[level]->marked.load() && preds[level]->next()[level].load() == victim;
+			if (!valid) {
+				unlock_preds(preds, top);
+				continue;
+			}
+			for (int level = top; level >= 0; --level)
+				preds[level]->next()[level].store(victim->next()[level].load(), std::memory_order_release);
+			victim->lock.unlock();
+			unlock_preds(preds, top);
+			num.fetch_sub(1, std::memory_order_relaxed);
+			retire(victim);
+			return true;
+		}
+	}
+	size_t count(const Key &key) const {
+		epoch_guard guard(this);
+		return find_node(key) ? 1 : 0;
+	}
+	/**
+	 * copy the value mapped to key into result.
+	 * returns false (and leaves result alone) if there is no such key.
+	 */
+	bool find(const Key &key, T &result) const {
+		epoch_guard guard(this);
+		node *p = find_node(key);
+		if (!p) return false;
+		result = p->valptr()->second;
+		return true;
+	}
+	/**
+	 * returns a copy of the value mapped to key.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	T at(const Key &key) const {
+		epoch_guard guard(this);
+		node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		return p->valptr()->second;
+	}
+};
+
+}
+
+#endif
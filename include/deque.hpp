@@ -4,183 +4,641 @@
 #include "exceptions.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <type_traits>
 
-namespace sjtu { 
+namespace sjtu {
 
+/**
+ * a doubly linked list of blocks, each holding a contiguous run of elements.
+ *
+ * a block keeps its elements in [beg, end) of its own buffer, so pushing at
+ *   either end of the deque is O(1) until the outer block fills up.
+ * every block has its own capacity: new blocks get about 2 sqrt(n) slots
+ *   (never fewer than min_block_bytes worth), which keeps both the number of
+ *   blocks and the cost of shifting inside a block at O(sqrt n).
+ * a full block is split in half before an insertion into its middle, and a
+ *   block is merged into its successor when both fit into one.
+ *
+ * elements are only ever copy- or move-constructed and destroyed, never
+ *   assigned, so T does not need an assignment operator.
+ */
 template<class T>
 class deque {
+private:
+	static const size_t min_block_bytes = 512;
+	struct block {
+		block *prev, *next;
+		size_t cap, beg, end;
+		T *buf;
+		size_t size() const { return end - beg; }
+	};
+
+	block *head, *tail;
+	size_t num;
+
+	static block *allocate_block(size_t cap, size_t beg) {
+		block *b = new block;
+		try {
+			b->buf = static_cast<T *>(::operator new(cap * sizeof(T)));
+		} catch (...) {
+			delete b;
+			throw;
+		}
+		b->prev = b->next = nullptr;
+		b->cap = cap;
+		b->beg = b->end = beg;
+		return b;
+	}
+	static void free_block(block *b) {
+		for (size_t i = b->beg; i < b->end; ++i) b->buf[i].~T();
+		::operator delete(b->buf);
+		delete b;
+	}
+	/**
+	 * the capacity for a new block of a deque holding n elements.
+	 * root * root < n is tested as root <= (n - 1) / root so it cannot overflow.
+	 */
+	static size_t block_capacity(size_t n) {
+		size_t cap = min_block_bytes / sizeof(T);
+		if (cap < 8) cap = 8;
+		size_t root = 1;
+		while (n && root <= (n - 1) / root) root <<= 1;
+		return cap < 2 * root ? 2 * root : cap;
+	}
+	/**
+	 * move the element at from to the raw slot at to, leaving from raw.
+	 */
+	static void relocate(T *to, T *from) {
+		new (to) T(std::move(*from));
+		from->~T();
+	}
+	void link_after(block *pos, block *b) {
+		b->prev = pos;
+		b->next = pos ? pos->next : head;
+		(b->next ? b->next->prev : tail) = b;
+		(pos ? pos->next : head) = b;
+	}
+	void unlink(block *b) {
+		(b->prev ? b->prev->next : head) = b->next;
+		(b->next ? b->next->prev : tail) = b->prev;
+	}
+	/**
+	 * move the upper half of a full block into a new block right after it.
+	 */
+	void split(block *b) {
+		size_t half = b->size() / 2;
+		block *nb = allocate_block(b->cap, 0);
+		for (size_t i = b->end - half; i < b->end; ++i) relocate(nb->buf + nb->end++, b->buf + i);
+		b->end -= half;
+		link_after(b, nb);
+	}
+	/**
+	 * empty blocks are released, and b is merged with its successor when
+	 *   both fit into b.
+	 */
+	void rebalance(block *b) {
+		if (b->size() == 0) {
+			unlink(b);
+			free_block(b);
+			return;
+		}
+		block *nb = b->next;
+		if (!nb || b->size() + nb->size() > b->cap) return;
+		if (b->end + nb->size() > b->cap) {
+			for (size_t i = b->beg; i < b->end; ++i) relocate(b->buf + (i - b->beg), b->buf + i);
+			b->end -= b->beg;
+			b->beg = 0;
+		}
+		for (size_t i = nb->beg; i < nb->end; ++i) relocate(b->buf + b->end++, nb->buf + i);
+		nb->end = nb->beg;
+		unlink(nb);
+		free_block(nb);
+	}
+	/**
+	 * the block and buffer slot of the element at rank pos < num,
+	 *   found by walking from whichever end of the deque is nearer.
+	 */
+	void locate(size_t pos, block *&b, size_t &i) const {
+		if (pos < num / 2) {
+			for (b = head; pos >= b->size(); b = b->next) pos -= b->size();
+			i = b->beg + pos;
+		} else {
+			size_t back = num - pos;
+			for (b = tail; back > b->size(); b = b->prev) back -= b->size();
+			i = b->end - back;
+		}
+	}
+	/**
+	 * the rank of the element at (b, i); num for the past-the-end position.
+	 */
+	size_t rank(const block *b, size_t i) const {
+		if (!b) return num;
+		size_t res = i - b->beg;
+		for (const block *p = b->prev; p; p = p->prev) res += p->size();
+		return res;
+	}
+	/**
+	 * step n elements from (b, i), where a null b is past-the-end.
+	 * throw index_out_of_bound if the result is outside [begin, end].
+	 */
+	static void advance(const deque *owner, block *&b, size_t &i, long long n) {
+		if (!owner) throw invalid_iterator();
+		if (n >= 0) {
+			while (n > 0) {
+				if (!b) throw index_out_of_bound();
+				size_t room = b->end - i;
+				if ((unsigned long long)n < room) {
+					i += n;
+					return;
+				}
+				n -= room;
+				b = b->next;
+				i = b ? b->beg : 0;
+			}
+		} else {
+			if (!b) {
+				if (!owner->tail) throw index_out_of_bound();
+				b = owner->tail;
+				i = b->end;
+			}
+			for (n = -n; ; ) {
+				size_t room = i - b->beg;
+				if ((unsigned long long)n <= room) {
+					i -= n;
+					return;
+				}
+				n -= room;
+				b = b->prev;
+				if (!b) throw index_out_of_bound();
+				i = b->end;
+			}
+		}
+	}
+	void copy_from(const deque &other) {
+		for (const block *b = other.head; b; b = b->next)
+			for (size_t i = b->beg; i < b->end; ++i) push_back(b->buf[i]);
+	}
+	/**
+	 * header of the serialize() format; the elements follow it back to back.
+	 */
+	struct stream_header {
+		char magic[8];
+		uint32_t version, byte_order;
+		uint64_t value_size, count;
+	};
+	static stream_header header_for(size_t count) {
+		stream_header h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, "SJTUDEQ", 8);
+		h.version = 1;
+		h.byte_order = 0x01020304;
+		h.value_size = sizeof(T);
+		h.count = count;
+		return h;
+	}
 public:
 	class const_iterator;
 	class iterator {
+		friend class deque;
+		friend class const_iterator;
 	private:
 		/**
-		 * TODO add data members
-		 *   just add whatever you want.
+		 * the deque this iterator belongs to, and the block and buffer slot
+		 *   it points at. past-the-end is represented by a null block.
 		 */
+		deque *owner;
+		block *blk;
+		size_t idx;
+		iterator(deque *owner, block *blk, size_t idx) : owner(owner), blk(blk), idx(idx) {}
 	public:
+		iterator() : owner(nullptr), blk(nullptr), idx(0) {}
+		iterator(const iterator &other) : owner(other.owner), blk(other.blk), idx(other.idx) {}
+		iterator & operator=(const iterator &other) = default;
 		/**
 		 * return a new iterator which pointer n-next elements
 		 *   even if there are not enough elements, the behaviour is **undefined**.
 		 * as well as operator-
+		 * here both throw index_out_of_bound when the result is outside [begin, end].
 		 */
 		iterator operator+(const int &n) const {
-			//TODO
+			iterator res = *this;
+			return res += n;
 		}
 		iterator operator-(const int &n) const {
-			//TODO
+			iterator res = *this;
+			return res -= n;
 		}
 		// return th distance between two iterator,
 		// if these two iterators points to different vectors, throw invaild_iterator.
 		int operator-(const iterator &rhs) const {
-			//TODO
+			if (!owner || owner != rhs.owner) throw invalid_iterator();
+			return (int)owner->rank(blk, idx) - (int)owner->rank(rhs.blk, rhs.idx);
 		}
-		iterator operator+=(const int &n) {
-			//TODO
+		iterator & operator+=(const int &n) {
+			advance(owner, blk, idx, n);
+			return *this;
 		}
-		iterator operator-=(const int &n) {
-			//TODO
+		iterator & operator-=(const int &n) {
+			advance(owner, blk, idx, -(long long)n);
+			return *this;
 		}
 		/**
-		 * TODO iter++
+		 * iter++
 		 */
-		iterator operator++(int) {}
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
 		/**
-		 * TODO ++iter
+		 * ++iter
 		 */
-		iterator& operator++() {}
+		iterator & operator++() {
+			return *this += 1;
+		}
 		/**
-		 * TODO iter--
+		 * iter--
 		 */
-		iterator operator--(int) {}
+		iterator operator--(int) {
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
 		/**
-		 * TODO --iter
+		 * --iter
 		 */
-		iterator& operator--() {}
+		iterator & operator--() {
+			return *this -= 1;
+		}
 		/**
-		 * TODO *it
+		 * *it
+		 * throw invalid_iterator on past-the-end.
 		 */
-		T& operator*() const {}
+		T & operator*() const {
+			if (!blk) throw invalid_iterator();
+			return blk->buf[idx];
+		}
 		/**
-		 * TODO it->field
+		 * it->field
 		 */
-		T* operator->() const noexcept {}
+		T * operator->() const noexcept {
+			return blk->buf + idx;
+		}
 		/**
 		 * a operator to check whether two iterators are same (pointing to the same memory).
 		 */
-		bool operator==(const iterator &rhs) const {}
-		bool operator==(const const_iterator &rhs) const {}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && blk == rhs.blk && idx == rhs.idx; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && blk == rhs.blk && idx == rhs.idx; }
 		/**
 		 * some other operator for iterator.
 		 */
-		bool operator!=(const iterator &rhs) const {}
-		bool operator!=(const const_iterator &rhs) const {}
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 	};
 	class const_iterator {
 		// it should has similar member method as iterator.
 		//  and it should be able to construct from an iterator.
+		friend class deque;
+		friend class iterator;
 		private:
-			// data members.
+			const deque *owner;
+			block *blk;
+			size_t idx;
+			const_iterator(const deque *owner, block *blk, size_t idx) : owner(owner), blk(blk), idx(idx) {}
 		public:
-			const_iterator() {
-				// TODO
+			const_iterator() : owner(nullptr), blk(nullptr), idx(0) {}
+			const_iterator(const const_iterator &other) : owner(other.owner), blk(other.blk), idx(other.idx) {}
+			const_iterator(const iterator &other) : owner(other.owner), blk(other.blk), idx(other.idx) {}
+			const_iterator & operator=(const const_iterator &other) = default;
+			const_iterator operator+(const int &n) const {
+				const_iterator res = *this;
+				return res += n;
+			}
+			const_iterator operator-(const int &n) const {
+				const_iterator res = *this;
+				return res -= n;
+			}
+			int operator-(const const_iterator &rhs) const {
+				if (!owner || owner != rhs.owner) throw invalid_iterator();
+				return (int)owner->rank(blk, idx) - (int)owner->rank(rhs.blk, rhs.idx);
+			}
+			const_iterator & operator+=(const int &n) {
+				advance(owner, blk, idx, n);
+				return *this;
+			}
+			const_iterator & operator-=(const int &n) {
+				advance(owner, blk, idx, -(long long)n);
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
 			}
-			const_iterator(const const_iterator &other) {
-				// TODO
+			const_iterator & operator++() {
+				return *this += 1;
 			}
-			const_iterator(const iterator &other) {
-				// TODO
+			const_iterator operator--(int) {
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
 			}
-			// And other methods in iterator.
-			// And other methods in iterator.
-			// And other methods in iterator.
+			const_iterator & operator--() {
+				return *this -= 1;
+			}
+			const T & operator*() const {
+				if (!blk) throw invalid_iterator();
+				return blk->buf[idx];
+			}
+			const T * operator->() const noexcept {
+				return blk->buf + idx;
+			}
+			bool operator==(const iterator &rhs) const { return owner == rhs.owner && blk == rhs.blk && idx == rhs.idx; }
+			bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && blk == rhs.blk && idx == rhs.idx; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 	};
 	/**
-	 * TODO Constructors
+	 * Constructors
 	 */
-	deque() {}
-	deque(const deque &other) {}
+	deque() : head(nullptr), tail(nullptr), num(0) {}
+	deque(const deque &other) : head(nullptr), tail(nullptr), num(0) {
+		try {
+			copy_from(other);
+		} catch (...) {
+			clear();
+			throw;
+		}
+	}
 	/**
-	 * TODO Deconstructor
+	 * Deconstructor
 	 */
-	~deque() {}
+	~deque() {
+		clear();
+	}
 	/**
-	 * TODO assignment operator
+	 * assignment operator
 	 */
-	deque &operator=(const deque &other) {}
+	deque & operator=(const deque &other) {
+		if (this == &other) return *this;
+		deque tmp(other);
+		std::swap(head, tmp.head);
+		std::swap(tail, tmp.tail);
+		std::swap(num, tmp.num);
+		return *this;
+	}
 	/**
 	 * access specified element with bounds checking
 	 * throw index_out_of_bound if out of bound.
 	 */
-	T & at(const size_t &pos) {}
-	const T & at(const size_t &pos) const {}
-	T & operator[](const size_t &pos) {}
-	const T & operator[](const size_t &pos) const {}
+	T & at(const size_t &pos) {
+		if (pos >= num) throw index_out_of_bound();
+		block *b;
+		size_t i;
+		locate(pos, b, i);
+		return b->buf[i];
+	}
+	const T & at(const size_t &pos) const {
+		if (pos >= num) throw index_out_of_bound();
+		block *b;
+		size_t i;
+		locate(pos, b, i);
+		return b->buf[i];
+	}
+	T & operator[](const size_t &pos) { return at(pos); }
+	const T & operator[](const size_t &pos) const { return at(pos); }
 	/**
 	 * access the first element
 	 * throw container_is_empty when the container is empty.
 	 */
-	const T & front() const {}
+	const T & front() const {
+		if (!num) throw container_is_empty();
+		return head->buf[head->beg];
+	}
 	/**
 	 * access the last element
 	 * throw container_is_empty when the container is empty.
 	 */
-	const T & back() const {}
+	const T & back() const {
+		if (!num) throw container_is_empty();
+		return tail->buf[tail->end - 1];
+	}
 	/**
 	 * returns an iterator to the beginning.
 	 */
-	iterator begin() {}
-	const_iterator cbegin() const {}
+	iterator begin() { return iterator(this, head, head ? head->beg : 0); }
+	const_iterator cbegin() const { return const_iterator(this, head, head ? head->beg : 0); }
 	/**
 	 * returns an iterator to the end.
 	 */
-	iterator end() {}
-	const_iterator cend() const {}
+	iterator end() { return iterator(this, nullptr, 0); }
+	const_iterator cend() const { return const_iterator(this, nullptr, 0); }
 	/**
 	 * checks whether the container is empty.
 	 */
-	bool empty() const {}
+	bool empty() const { return num == 0; }
 	/**
 	 * returns the number of elements
 	 */
-	size_t size() const {}
+	size_t size() const { return num; }
 	/**
 	 * clears the contents
 	 */
-	void clear() {}
+	void clear() {
+		while (head) {
+			block *b = head;
+			head = b->next;
+			free_block(b);
+		}
+		tail = nullptr;
+		num = 0;
+	}
 	/**
 	 * inserts elements at the specified locat on in the container.
 	 * inserts value before pos
 	 * returns an iterator pointing to the inserted value
 	 *     throw if the iterator is invalid or it point to a wrong place.
 	 */
-	iterator insert(iterator pos, const T &value) {}
+	iterator insert(iterator pos, const T &value) {
+		if (pos.owner != this) throw invalid_iterator();
+		if (!pos.blk) {
+			push_back(value);
+			return iterator(this, tail, tail->end - 1);
+		}
+		if (pos.blk == head && pos.idx == head->beg) {
+			push_front(value);
+			return begin();
+		}
+		// value may live in this deque, so it is copied before anything moves.
+		T tmp(value);
+		block *b = pos.blk;
+		size_t i = pos.idx;
+		if (b->size() == b->cap) {
+			split(b);
+			if (i >= b->end) {
+				i -= b->end;
+				b = b->next;
+			}
+		}
+		if (b->end < b->cap && (b->beg == 0 || i - b->beg >= b->end - i)) {
+			for (size_t j = b->end; j > i; --j) relocate(b->buf + j, b->buf + j - 1);
+			++b->end;
+		} else {
+			for (size_t j = b->beg; j < i; ++j) relocate(b->buf + j - 1, b->buf + j);
+			--b->beg;
+			--i;
+		}
+		new (b->buf + i) T(std::move(tmp));
+		++num;
+		return iterator(this, b, i);
+	}
 	/**
 	 * removes specified element at pos.
 	 * removes the element at pos.
 	 * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
 	 * throw if the container is empty, the iterator is invalid or it points to a wrong place.
 	 */
-	iterator erase(iterator pos) {}
+	iterator erase(iterator pos) {
+		if (pos.owner != this || !pos.blk) throw invalid_iterator();
+		size_t r = rank(pos.blk, pos.idx);
+		block *b = pos.blk;
+		size_t i = pos.idx;
+		b->buf[i].~T();
+		if (i - b->beg < b->end - i - 1) {
+			for (size_t j = i; j > b->beg; --j) relocate(b->buf + j, b->buf + j - 1);
+			++b->beg;
+		} else {
+			for (size_t j = i + 1; j < b->end; ++j) relocate(b->buf + j - 1, b->buf + j);
+			--b->end;
+		}
+		--num;
+		rebalance(b);
+		if (r == num) return end();
+		locate(r, b, i);
+		return iterator(this, b, i);
+	}
 	/**
 	 * adds an element to the end
 	 */
-	void push_back(const T &value) {}
+	void push_back(const T &value) {
+		if (!tail || tail->end == tail->cap) {
+			block *b = allocate_block(block_capacity(num), 0);
+			try {
+				new (b->buf) T(value);
+			} catch (...) {
+				free_block(b);
+				throw;
+			}
+			b->end = 1;
+			link_after(tail, b);
+		} else {
+			new (tail->buf + tail->end) T(value);
+			++tail->end;
+		}
+		++num;
+	}
 	/**
 	 * removes the last element
 	 *     throw when the container is empty.
 	 */
-	void pop_back() {}
+	void pop_back() {
+		if (!num) throw container_is_empty();
+		tail->buf[--tail->end].~T();
+		--num;
+		if (tail->size() == 0) rebalance(tail);
+	}
 	/**
 	 * inserts an element to the beginning.
 	 */
-	void push_front(const T &value) {}
+	void push_front(const T &value) {
+		if (!head || head->beg == 0) {
+			size_t cap = block_capacity(num);
+			block *b = allocate_block(cap, cap);
+			try {
+				new (b->buf + cap - 1) T(value);
+			} catch (...) {
+				free_block(b);
+				throw;
+			}
+			b->beg = cap - 1;
+			link_after(nullptr, b);
+		} else {
+			new (head->buf + head->beg - 1) T(value);
+			--head->beg;
+		}
+		++num;
+	}
 	/**
 	 * removes the first element.
 	 *     throw when the container is empty.
 	 */
-	void pop_front() {}
+	void pop_front() {
+		if (!num) throw container_is_empty();
+		head->buf[head->beg++].~T();
+		--num;
+		if (head->size() == 0) rebalance(head);
+	}
+	/**
+	 * call f(const T *first, size_t count) once for every block, in order.
+	 * the runs are the deque's own storage, so they can be handed to writev()
+	 *   or any other scatter-gather writer without copying.
+	 */
+	template<class Function>
+	void for_each_block(Function f) const {
+		for (const block *b = head; b; b = b->next) f(const_cast<const T *>(b->buf + b->beg), b->size());
+	}
+	/**
+	 * write the elements as raw bytes, one write per block, after a small
+	 *   header with the element size, count and byte order.
+	 * T must be trivially copyable.
+	 * throw runtime_error if the stream fails.
+	 */
+	void serialize(std::ostream &os) const {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements can be serialized");
+		stream_header h = header_for(num);
+		os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+		for (const block *b = head; b && os; b = b->next)
+			os.write(reinterpret_cast<const char *>(b->buf + b->beg), b->size() * sizeof(T));
+		if (!os) throw runtime_error();
+	}
+	/**
+	 * replace the contents with elements written by serialize().
+	 * the count in the header decides the block size up front, and every
+	 *   block is filled with a single read straight into its buffer.
+	 * throw runtime_error, leaving the deque unchanged, if the stream fails,
+	 *   was written for another element size or byte order, or claims more
+	 *   elements than could ever fit in memory.
+	 */
+	void deserialize(std::istream &is) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements can be deserialized");
+		stream_header h, expect;
+		if (!is.read(reinterpret_cast<char *>(&h), sizeof(h))) throw runtime_error();
+		expect = header_for((size_t)h.count);
+		if (std::memcmp(&h, &expect, sizeof(h)) != 0) throw runtime_error();
+		if (h.count > (uint64_t)(PTRDIFF_MAX / sizeof(T))) throw runtime_error();
+		deque tmp;
+		size_t cap = block_capacity((size_t)h.count);
+		for (size_t left = (size_t)h.count; left > 0; ) {
+			size_t len = left < cap ? left : cap;
+			block *b = allocate_block(cap, 0);
+			tmp.link_after(tmp.tail, b);
+			if (!is.read(reinterpret_cast<char *>(b->buf), len * sizeof(T))) throw runtime_error();
+			b->end = len;
+			tmp.num += len;
+			left -= len;
+		}
+		std::swap(head, tmp.head);
+		std::swap(tail, tmp.tail);
+		std::swap(num, tmp.num);
+	}
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,549 @@
+/**
+ * a sorted-array companion of sjtu::map for read-mostly data
+ */
+#ifndef SJTU_FLAT_MAP_HPP
+#define SJTU_FLAT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * keys and mapped values are kept sorted in two separate arrays,
+ *   so a lookup only touches the key array and there is no per-element
+ *   node overhead at all.
+ * lookups are branchless binary searches; inserting or erasing a single
+ *   element shifts the tail of both arrays, and batches of new elements
+ *   are sorted and merged in one pass with insert(first, last).
+ *
+ * elements are never assigned to, only constructed and destroyed,
+ *   so Key and T need a copy constructor and nothing else.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class flat_map {
+public:
+	typedef pair<const Key, T> value_type;
+	/**
+	 * the elements are not stored as value_type, so iterators hand out
+	 *   a pair of references instead of a reference to a pair.
+	 */
+	typedef pair<const Key &, T &> reference;
+	typedef pair<const Key &, const T &> const_reference;
+private:
+	template<class Ref>
+	class arrow_proxy {
+	private:
+		Ref ref;
+	public:
+		explicit arrow_proxy(const Ref &ref) : ref(ref) {}
+		const Ref *operator->() const { return &ref; }
+	};
+
+	Key *keys;
+	T *vals;
+	size_t num, cap;
+	Compare cmp;
+
+	static Key *allocate_keys(size_t n) { return n ? static_cast<Key *>(::operator new(n * sizeof(Key))) : nullptr; }
+	static T *allocate_vals(size_t n) { return n ? static_cast<T *>(::operator new(n * sizeof(T))) : nullptr; }
+	static void destroy(Key *k, T *v, size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			k[i].~Key();
+			v[i].~T();
+		}
+	}
+	void release() {
+		destroy(keys, vals, num);
+		::operator delete(keys);
+		::operator delete(vals);
+		keys = nullptr;
+		vals = nullptr;
+		num = cap = 0;
+	}
+	/**
+	 * construct the pair (k, v) at slot i of the arrays nk and nv.
+	 */
+	template<class K, class V>
+	static void construct(Key *nk, T *nv, size_t i, K &&k, V &&v) {
+		new (nk + i) Key(std::forward<K>(k));
+		try {
+			new (nv + i) T(std::forward<V>(v));
+		} catch (...) {
+			nk[i].~Key();
+			throw;
+		}
+	}
+	/**
+	 * build fresh arrays of capacity newcap holding the current elements
+	 *   and switch to them. if k is given, (*k, *v) is placed at position gap
+	 *   and the elements from gap on move one slot right.
+	 * the old elements are moved only when that cannot throw,
+	 *   so a failure leaves the map unchanged.
+	 */
+	void rebuild(size_t newcap, size_t gap = 0, const Key *k = nullptr, const T *v = nullptr) {
+		Key *nk = allocate_keys(newcap);
+		T *nv = nullptr;
+		size_t done = 0;
+		bool placed = false;
+		try {
+			nv = allocate_vals(newcap);
+			if (k) {
+				construct(nk, nv, gap, *k, *v);
+				placed = true;
+			}
+			for (; done < num; ++done) {
+				size_t to = (k && done >= gap) ? done + 1 : done;
+				construct(nk, nv, to, std::move_if_noexcept(keys[done]), std::move_if_noexcept(vals[done]));
+			}
+		} catch (...) {
+			for (size_t i = 0; i < done; ++i) {
+				size_t to = (k && i >= gap) ? i + 1 : i;
+				nk[to].~Key();
+				nv[to].~T();
+			}
+			if (placed) {
+				nk[gap].~Key();
+				nv[gap].~T();
+			}
+			::operator delete(nk);
+			::operator delete(nv);
+			throw;
+		}
+		destroy(keys, vals, num);
+		::operator delete(keys);
+		::operator delete(vals);
+		keys = nk;
+		vals = nv;
+		cap = newcap;
+		if (k) ++num;
+	}
+	/**
+	 * construct a new element at pos, shifting [pos, num) one slot right.
+	 * elements are shifted in place only if moving them cannot throw;
+	 *   otherwise (or when full) the arrays are rebuilt around the new element.
+	 */
+	void insert_at(size_t pos, const Key &key, const T &value) {
+		const bool shift_in_place = num < cap
+			&& std::is_nothrow_move_constructible<Key>::value
+			&& std::is_nothrow_move_constructible<T>::value;
+		if (!shift_in_place) {
+			rebuild(num < cap ? cap : (cap ? cap * 2 : 4), pos, &key, &value);
+			return;
+		}
+		for (size_t i = num; i > pos; --i) {
+			construct(keys, vals, i, std::move(keys[i - 1]), std::move(vals[i - 1]));
+			keys[i - 1].~Key();
+			vals[i - 1].~T();
+		}
+		try {
+			construct(keys, vals, pos, key, value);
+		} catch (...) {
+			// close the hole again before reporting the failure.
+			for (size_t i = pos; i < num; ++i) {
+				construct(keys, vals, i, std::move(keys[i + 1]), std::move(vals[i + 1]));
+				keys[i + 1].~Key();
+				vals[i + 1].~T();
+			}
+			throw;
+		}
+		++num;
+	}
+	/**
+	 * remove [a, b), shifting the tail down in place if moving it cannot throw.
+	 * otherwise the survivors are copied into fresh arrays first,
+	 *   so a failing copy leaves the map unchanged.
+	 */
+	void erase_at(size_t a, size_t b) {
+		if (!std::is_nothrow_move_constructible<Key>::value || !std::is_nothrow_move_constructible<T>::value) {
+			Key *nk = allocate_keys(cap);
+			T *nv = nullptr;
+			size_t done = 0;
+			try {
+				nv = allocate_vals(cap);
+				for (size_t i = 0; i < num; ++i) {
+					if (i == a) i = b;
+					if (i == num) break;
+					construct(nk, nv, done, keys[i], vals[i]);
+					++done;
+				}
+			} catch (...) {
+				destroy(nk, nv, done);
+				::operator delete(nk);
+				::operator delete(nv);
+				throw;
+			}
+			destroy(keys, vals, num);
+			::operator delete(keys);
+			::operator delete(vals);
+			keys = nk;
+			vals = nv;
+			num = done;
+			return;
+		}
+		for (size_t i = a; i < b; ++i) {
+			keys[i].~Key();
+			vals[i].~T();
+		}
+		size_t d = b - a;
+		for (size_t i = b; i < num; ++i) {
+			construct(keys, vals, i - d, std::move(keys[i]), std::move(vals[i]));
+			keys[i].~Key();
+			vals[i].~T();
+		}
+		num -= d;
+	}
+	/**
+	 * branchless lower bound: the loop has a fixed trip count for a given
+	 *   size and the step is a conditional move, not a branch.
+	 */
+	template<class K>
+	size_t lower_index(const K &key) const {
+		if (num == 0) return 0;
+		const Key *base = keys;
+		size_t len = num;
+		while (len > 1) {
+			size_t half = len / 2;
+			base = cmp(base[half - 1], key) ? base + half : base;
+			len -= half;
+		}
+		return (base - keys) + (cmp(*base, key) ? 1 : 0);
+	}
+	template<class K>
+	size_t upper_index(const K &key) const {
+		if (num == 0) return 0;
+		const Key *base = keys;
+		size_t len = num;
+		while (len > 1) {
+			size_t half = len / 2;
+			base = cmp(key, base[half - 1]) ? base : base + half;
+			len -= half;
+		}
+		return (base - keys) + (cmp(key, *base) ? 0 : 1);
+	}
+	template<class K>
+	size_t find_index(const K &key) const {
+		size_t i = lower_index(key);
+		return (i < num && !cmp(key, keys[i])) ? i : num;
+	}
+public:
+	/**
+	 * random access iterators over the two arrays.
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 *     like it = map.begin(); --it;
+	 *       or it = map.end(); ++end();
+	 */
+	class const_iterator;
+	class iterator {
+		friend class flat_map;
+		friend class const_iterator;
+	private:
+		flat_map *owner;
+		size_t pos;
+		iterator(flat_map *owner, size_t pos) : owner(owner), pos(pos) {}
+		iterator moved(long long n) const {
+			if (!owner) throw invalid_iterator();
+			long long k = (long long)pos + n;
+			if (k < 0 || k > (long long)owner->num) throw invalid_iterator();
+			return iterator(owner, (size_t)k);
+		}
+	public:
+		iterator() : owner(nullptr), pos(0) {}
+		iterator(const iterator &other) : owner(other.owner), pos(other.pos) {}
+		iterator & operator=(const iterator &other) = default;
+		iterator operator+(const int &n) const { return moved(n); }
+		iterator operator-(const int &n) const { return moved(-n); }
+		int operator-(const iterator &rhs) const {
+			if (!owner || owner != rhs.owner) throw invalid_iterator();
+			return (int)pos - (int)rhs.pos;
+		}
+		iterator & operator+=(const int &n) { return *this = moved(n); }
+		iterator & operator-=(const int &n) { return *this = moved(-n); }
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		iterator & operator++() { return *this = moved(1); }
+		iterator operator--(int) {
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		iterator & operator--() { return *this = moved(-1); }
+		reference operator*() const {
+			if (!owner || pos >= owner->num) throw invalid_iterator();
+			return reference(owner->keys[pos], owner->vals[pos]);
+		}
+		arrow_proxy<reference> operator->() const noexcept {
+			return arrow_proxy<reference>(reference(owner->keys[pos], owner->vals[pos]));
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && pos == rhs.pos; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && pos == rhs.pos; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+	class const_iterator {
+		friend class flat_map;
+		friend class iterator;
+	private:
+		const flat_map *owner;
+		size_t pos;
+		const_iterator(const flat_map *owner, size_t pos) : owner(owner), pos(pos) {}
+		const_iterator moved(long long n) const {
+			if (!owner) throw invalid_iterator();
+			long long k = (long long)pos + n;
+			if (k < 0 || k > (long long)owner->num) throw invalid_iterator();
+			return const_iterator(owner, (size_t)k);
+		}
+	public:
+		const_iterator() : owner(nullptr), pos(0) {}
+		const_iterator(const const_iterator &other) : owner(other.owner), pos(other.pos) {}
+		const_iterator(const iterator &other) : owner(other.owner), pos(other.pos) {}
+		const_iterator & operator=(const const_iterator &other) = default;
+		const_iterator operator+(const int &n) const { return moved(n); }
+		const_iterator operator-(const int &n) const { return moved(-n); }
+		int operator-(const const_iterator &rhs) const {
+			if (!owner || owner != rhs.owner) throw invalid_iterator();
+			return (int)pos - (int)rhs.pos;
+		}
+		const_iterator & operator+=(const int &n) { return *this = moved(n); }
+		const_iterator & operator-=(const int &n) { return *this = moved(-n); }
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		const_iterator & operator++() { return *this = moved(1); }
+		const_iterator operator--(int) {
+			const_iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		const_iterator & operator--() { return *this = moved(-1); }
+		const_reference operator*() const {
+			if (!owner || pos >= owner->num) throw invalid_iterator();
+			return const_reference(owner->keys[pos], owner->vals[pos]);
+		}
+		arrow_proxy<const_reference> operator->() const noexcept {
+			return arrow_proxy<const_reference>(const_reference(owner->keys[pos], owner->vals[pos]));
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && pos == rhs.pos; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && pos == rhs.pos; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+
+	flat_map() : keys(nullptr), vals(nullptr), num(0), cap(0) {}
+	flat_map(const flat_map &other) : keys(nullptr), vals(nullptr), num(0), cap(0), cmp(other.cmp) {
+		keys = allocate_keys(other.num);
+		try {
+			vals = allocate_vals(other.num);
+			cap = other.num;
+			for (; num < other.num; ++num) construct(keys, vals, num, other.keys[num], other.vals[num]);
+		} catch (...) {
+			release();
+			throw;
+		}
+	}
+	flat_map & operator=(const flat_map &other) {
+		if (this == &other) return *this;
+		flat_map tmp(other);
+		std::swap(keys, tmp.keys);
+		std::swap(vals, tmp.vals);
+		std::swap(num, tmp.num);
+		std::swap(cap, tmp.cap);
+		std::swap(cmp, tmp.cmp);
+		return *this;
+	}
+	~flat_map() {
+		release();
+	}
+	/**
+	 * access specified element with bounds checking.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	T & at(const Key &key) {
+		size_t i = find_index(key);
+		if (i == num) throw index_out_of_bound();
+		return vals[i];
+	}
+	const T & at(const Key &key) const {
+		size_t i = find_index(key);
+		if (i == num) throw index_out_of_bound();
+		return vals[i];
+	}
+	/**
+	 * access specified element, performing an insertion if such key does not already exist.
+	 */
+	T & operator[](const Key &key) {
+		size_t i = lower_index(key);
+		if (i == num || cmp(key, keys[i])) insert_at(i, key, T());
+		return vals[i];
+	}
+	/**
+	 * behave like at() throw index_out_of_bound if such key does not exist.
+	 */
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	iterator begin() { return iterator(this, 0); }
+	const_iterator cbegin() const { return const_iterator(this, 0); }
+	iterator end() { return iterator(this, num); }
+	const_iterator cend() const { return const_iterator(this, num); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	/**
+	 * the number of elements the arrays can hold without growing.
+	 */
+	size_t capacity() const { return cap; }
+	void reserve(size_t n) {
+		if (n > cap) rebuild(n);
+	}
+	void clear() {
+		destroy(keys, vals, num);
+		num = 0;
+	}
+	/**
+	 * insert an element.
+	 * return a pair, the first of the pair is
+	 *   the iterator to the new element (or the element that prevented the insertion),
+	 *   the second one is true if insert successfully, or false.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		size_t i = lower_index(value.first);
+		if (i < num && !cmp(value.first, keys[i])) return pair<iterator, bool>(iterator(this, i), false);
+		insert_at(i, value.first, value.second);
+		return pair<iterator, bool>(iterator(this, i), true);
+	}
+	/**
+	 * insert every element of [first, last) whose key is not present yet
+	 *   (for equal keys inside the batch the first one wins).
+	 * the batch is sorted on its own and then merged with the existing
+	 *   elements into fresh arrays in a single pass:
+	 *   O(n + k log k) instead of k shifts of the tail.
+	 */
+	template<class InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		flat_map batch;
+		for (; first != last; ++first) {
+			const value_type &v = *first;
+			if (batch.num == batch.cap) batch.rebuild(batch.cap ? batch.cap * 2 : 16);
+			construct(batch.keys, batch.vals, batch.num, v.first, v.second);
+			++batch.num;
+		}
+		if (batch.num == 0) return;
+		// sort the batch by position, then merge both sorted runs.
+		size_t *order = new size_t[batch.num];
+		for (size_t i = 0; i < batch.num; ++i) order[i] = i;
+		const Key *bk = batch.keys;
+		const Compare &c = cmp;
+		std::stable_sort(order, order + batch.num, [bk, &c](size_t a, size_t b) { return c(bk[a], bk[b]); });
+		Key *nk = nullptr;
+		T *nv = nullptr;
+		size_t n = 0, ncap = num + batch.num;
+		try {
+			nk = allocate_keys(ncap);
+			nv = allocate_vals(ncap);
+			size_t i = 0, j = 0;
+			while (i < num || j < batch.num) {
+				const Key *k;
+				const T *v;
+				if (j == batch.num || (i < num && !cmp(bk[order[j]], keys[i]))) {
+					// an existing element goes first and wins over an equal new one.
+					k = keys + i;
+					v = vals + i;
+					if (j < batch.num && !cmp(keys[i], bk[order[j]])) ++j;
+					++i;
+				} else {
+					k = bk + order[j];
+					v = batch.vals + order[j];
+					++j;
+				}
+				if (n > 0 && !cmp(nk[n - 1], *k)) continue;
+				construct(nk, nv, n, *k, *v);
+				++n;
+			}
+		} catch (...) {
+			destroy(nk, nv, n);
+			::operator delete(nk);
+			::operator delete(nv);
+			delete [] order;
+			throw;
+		}
+		delete [] order;
+		release();
+		keys = nk;
+		vals = nv;
+		num = n;
+		cap = ncap;
+	}
+	/**
+	 * erase the element at pos.
+	 *
+	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 */
+	void erase(iterator pos) {
+		if (pos.owner != this || pos.pos >= num) throw invalid_iterator();
+		erase_at(pos.pos, pos.pos + 1);
+	}
+	/**
+	 * erase the elements in [first, last).
+	 */
+	void erase(iterator first, iterator last) {
+		if (first.owner != this || last.owner != this || first.pos > last.pos) throw invalid_iterator();
+		erase_at(first.pos, last.pos);
+	}
+	size_t count(const Key &key) const { return find_index(key) < num ? 1 : 0; }
+	iterator find(const Key &key) { return iterator(this, find_index(key)); }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_index(key)); }
+	iterator lower_bound(const Key &key) { return iterator(this, lower_index(key)); }
+	const_iterator lower_bound(const Key &key) const { return const_iterator(this, lower_index(key)); }
+	iterator upper_bound(const Key &key) { return iterator(this, upper_index(key)); }
+	const_iterator upper_bound(const Key &key) const { return const_iterator(this, upper_index(key)); }
+	pair<iterator, iterator> equal_range(const Key &key) {
+		return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+		return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+	}
+	iterator nth(size_t k) { return iterator(this, k < num ? k : num); }
+	const_iterator nth(size_t k) const { return const_iterator(this, k < num ? k : num); }
+	size_t rank(const Key &key) const { return lower_index(key); }
+	/**
+	 * heterogeneous lookup, enabled only when Compare::is_transparent names a type.
+	 */
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	T & at(const K &key) {
+		size_t i = find_index(key);
+		if (i == num) throw index_out_of_bound();
+		return vals[i];
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const T & at(const K &key) const {
+		size_t i = find_index(key);
+		if (i == num) throw index_out_of_bound();
+		return vals[i];
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	size_t count(const K &key) const { return find_index(key) < num ? 1 : 0; }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	iterator find(const K &key) { return iterator(this, find_index(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const_iterator find(const K &key) const { return const_iterator(this, find_index(key)); }
+};
+
+}
+
+#endif
@@ -0,0 +1,426 @@
+/**
+ * a read-only snapshot of sjtu::map laid out for fast searching
+ */
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SJTU_FROZEN_MAP_MMAP
+#endif
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu {
+
+/**
+ * the keys are stored in Eytzinger (BFS) order in one array:
+ *   the children of slot k are 2k and 2k + 1, and slot 0 is unused.
+ * a search is a fixed descent k = 2k + (keys[k] < key) with no
+ *   data-dependent branch, and the key blocks a few levels below are
+ *   prefetched while the current level is compared.
+ * the top of the tree shares a handful of cache lines, which stay hot
+ *   across lookups, unlike the scattered nodes of a red-black tree.
+ *
+ * the mapped values live in a second array in the same order,
+ *   so they are only touched once a key has been found.
+ *
+ * both arrays are position independent, so save() writes them to a file
+ *   as they are, and load_mmap() serves lookups straight from a read-only
+ *   mapping of that file: opening costs the same for any size, and pages
+ *   are read in on first touch. the file is a 4096-byte header page, then
+ *   the key array and the value array, each starting on a page boundary.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class frozen_map {
+public:
+	typedef pair<const Key, T> value_type;
+	typedef pair<const Key &, const T &> const_reference;
+private:
+	template<class Ref>
+	class arrow_proxy {
+	private:
+		Ref ref;
+	public:
+		explicit arrow_proxy(const Ref &ref) : ref(ref) {}
+		const Ref *operator->() const { return &ref; }
+	};
+
+	// how many keys share a cache line, i.e. how far a prefetch can reach ahead.
+	static const size_t keys_per_line = sizeof(Key) >= 64 ? 1 : 64 / sizeof(Key);
+
+	Key *keys;
+	T *vals;
+	size_t num;
+	Compare cmp;
+	// the file mapping keys and vals point into, or null if they are owned.
+	void *mapping;
+	size_t mapping_length;
+
+	static const size_t page_size = 4096;
+	struct file_header {
+		char magic[8];
+		uint32_t version, byte_order;
+		uint64_t key_size, value_size, count, keys_offset, values_offset, length;
+	};
+	static size_t page_align(size_t n) { return (n + page_size - 1) / page_size * page_size; }
+	static file_header header_for(size_t num) {
+		file_header h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, "SJTUFMAP", 8);
+		h.version = 1;
+		h.byte_order = 0x01020304;
+		h.key_size = sizeof(Key);
+		h.value_size = sizeof(T);
+		h.count = num;
+		h.keys_offset = page_size;
+		h.values_offset = page_align(h.keys_offset + (num + 1) * sizeof(Key));
+		h.length = page_align(h.values_offset + (num + 1) * sizeof(T));
+		return h;
+	}
+
+	void release() {
+#ifdef SJTU_FROZEN_MAP_MMAP
+		if (mapping) {
+			munmap(mapping, mapping_length);
+			return;
+		}
+#endif
+		for (size_t k = 1; k <= num; ++k) {
+			keys[k].~Key();
+			vals[k].~T();
+		}
+		::operator delete(keys);
+		::operator delete(vals);
+	}
+	/**
+	 * fill the slots of the subtree rooted at k in order from it,
+	 *   the slots already done are counted in built.
+	 */
+	template<class Iterator>
+	void fill(size_t k, Iterator &it, size_t &built) {
+		// in-order walk of the implicit tree, without recursion.
+		size_t stack[sizeof(size_t) * 8 + 1], top = 0;
+		for (;;) {
+			for (; k <= num; k *= 2) stack[top++] = k;
+			if (top == 0) return;
+			k = stack[--top];
+			new (keys + k) Key(it->first);
+			try {
+				new (vals + k) T(it->second);
+			} catch (...) {
+				keys[k].~Key();
+				throw;
+			}
+			++built;
+			++it;
+			k = 2 * k + 1;
+		}
+	}
+	/**
+	 * the slot of the first key not less than key, or 0 if there is none.
+	 */
+	template<class K>
+	size_t lower_slot(const K &key) const {
+		size_t k = 1;
+		while (k <= num) {
+#ifdef __GNUC__
+			__builtin_prefetch(keys + k * keys_per_line);
+#endif
+			k = 2 * k + (cmp(keys[k], key) ? 1 : 0);
+		}
+		// undo the trailing right turns and the last left turn.
+		while (k & 1) k >>= 1;
+		return k >> 1;
+	}
+	template<class K>
+	size_t find_slot(const K &key) const {
+		size_t k = lower_slot(key);
+		return (k && !cmp(key, keys[k])) ? k : 0;
+	}
+	size_t first_slot() const {
+		size_t k = 0;
+		for (size_t c = 1; c <= num; c *= 2) k = c;
+		return k;
+	}
+	size_t last_slot() const {
+		size_t k = 0;
+		for (size_t c = 1; c <= num; c = 2 * c + 1) k = c;
+		return k;
+	}
+	size_t next_slot(size_t k) const {
+		if (2 * k + 1 <= num) {
+			k = 2 * k + 1;
+			while (2 * k <= num) k *= 2;
+			return k;
+		}
+		while (k & 1) k >>= 1;
+		return k >> 1;
+	}
+	size_t prev_slot(size_t k) const {
+		if (2 * k <= num) {
+			k = 2 * k;
+			while (2 * k + 1 <= num) k = 2 * k + 1;
+			return k;
+		}
+		while (k > 1 && !(k & 1)) k >>= 1;
+		return k >> 1;
+	}
+public:
+	/**
+	 * a bidirectional iterator in key order; slot 0 stands for end().
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 */
+	class const_iterator {
+		friend class frozen_map;
+	private:
+		const frozen_map *owner;
+		size_t slot;
+		const_iterator(const frozen_map *owner, size_t slot) : owner(owner), slot(slot) {}
+	public:
+		const_iterator() : owner(nullptr), slot(0) {}
+		const_iterator(const const_iterator &other) : owner(other.owner), slot(other.slot) {}
+		const_iterator & operator=(const const_iterator &other) = default;
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		const_iterator & operator++() {
+			if (!owner || !slot) throw invalid_iterator();
+			slot = owner->next_slot(slot);
+			return *this;
+		}
+		const_iterator operator--(int) {
+			const_iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		const_iterator & operator--() {
+			if (!owner) throw invalid_iterator();
+			size_t k = slot ? owner->prev_slot(slot) : owner->last_slot();
+			if (!k) throw invalid_iterator();
+			slot = k;
+			return *this;
+		}
+		const_reference operator*() const {
+			if (!owner || !slot) throw invalid_iterator();
+			return const_reference(owner->keys[slot], owner->vals[slot]);
+		}
+		arrow_proxy<const_reference> operator->() const noexcept {
+			return arrow_proxy<const_reference>(const_reference(owner->keys[slot], owner->vals[slot]));
+		}
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && slot == rhs.slot; }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+	typedef const_iterator iterator;
+
+	frozen_map() : keys(nullptr), vals(nullptr), num(0), mapping(nullptr), mapping_length(0) {}
+	/**
+	 * build the index from the elements of m in O(n).
+	 */
+	template<class Augment>
+	explicit frozen_map(const map<Key, T, Compare, Augment> &m)
+		: keys(nullptr), vals(nullptr), num(m.size()), mapping(nullptr), mapping_length(0) {
+		build(m.cbegin());
+	}
+	/**
+	 * the copy owns its elements, even if other is a file mapping.
+	 */
+	frozen_map(const frozen_map &other)
+		: keys(nullptr), vals(nullptr), num(other.num), cmp(other.cmp), mapping(nullptr), mapping_length(0) {
+		build(other.cbegin());
+	}
+	frozen_map(frozen_map &&other)
+		: keys(other.keys), vals(other.vals), num(other.num), cmp(other.cmp),
+		  mapping(other.mapping), mapping_length(other.mapping_length) {
+		other.keys = nullptr;
+		other.vals = nullptr;
+		other.num = 0;
+		other.mapping = nullptr;
+	}
+	frozen_map & operator=(const frozen_map &other) {
+		if (this == &other) return *this;
+		frozen_map tmp(other);
+		swap(tmp);
+		return *this;
+	}
+	frozen_map & operator=(frozen_map &&other) {
+		if (this == &other) return *this;
+		frozen_map tmp(std::move(other));
+		swap(tmp);
+		return *this;
+	}
+	void swap(frozen_map &other) {
+		std::swap(keys, other.keys);
+		std::swap(vals, other.vals);
+		std::swap(num, other.num);
+		std::swap(cmp, other.cmp);
+		std::swap(mapping, other.mapping);
+		std::swap(mapping_length, other.mapping_length);
+	}
+	~frozen_map() {
+		release();
+	}
+	/**
+	 * access specified element with bounds checking.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	const T & at(const Key &key) const {
+		size_t k = find_slot(key);
+		if (!k) throw index_out_of_bound();
+		return vals[k];
+	}
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	const_iterator begin() const { return const_iterator(this, first_slot()); }
+	const_iterator cbegin() const { return const_iterator(this, first_slot()); }
+	const_iterator end() const { return const_iterator(this, 0); }
+	const_iterator cend() const { return const_iterator(this, 0); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	size_t count(const Key &key) const { return find_slot(key) ? 1 : 0; }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_slot(key)); }
+	const_iterator lower_bound(const Key &key) const { return const_iterator(this, lower_slot(key)); }
+	/**
+	 * heterogeneous lookup, enabled only when Compare::is_transparent names a type.
+	 */
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const T & at(const K &key) const {
+		size_t k = find_slot(key);
+		if (!k) throw index_out_of_bound();
+		return vals[k];
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	size_t count(const K &key) const { return find_slot(key) ? 1 : 0; }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const_iterator find(const K &key) const { return const_iterator(this, find_slot(key)); }
+	/**
+	 * write the image to path, replacing the file.
+	 * Key and T must be trivially copyable, and the file can only be read back
+	 *   by a build with the same sizes and byte order, which load_mmap checks.
+	 * throw runtime_error if the file cannot be written.
+	 */
+	void save(const char *path) const {
+		static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+			"only trivially copyable keys and values can be saved");
+		file_header h = header_for(num);
+		FILE *f = std::fopen(path, "wb");
+		if (!f) throw runtime_error();
+		unsigned char zeros[page_size] = {};
+		bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1
+			&& std::fwrite(zeros, 1, page_size - sizeof(h), f) == page_size - sizeof(h);
+		// slot 0 is unused; it is written as zeros so the arrays keep their indices.
+		size_t key_bytes = (num + 1) * sizeof(Key), value_bytes = (num + 1) * sizeof(T);
+		ok = ok && std::fwrite(zeros, 1, sizeof(Key), f) == sizeof(Key)
+			&& (num == 0 || std::fwrite(keys + 1, sizeof(Key), num, f) == num)
+			&& write_padding(f, h.values_offset - h.keys_offset - key_bytes, zeros)
+			&& std::fwrite(zeros, 1, sizeof(T), f) == sizeof(T)
+			&& (num == 0 || std::fwrite(vals + 1, sizeof(T), num, f) == num)
+			&& write_padding(f, h.length - h.values_offset - value_bytes, zeros);
+		if (std::fclose(f) != 0 || !ok) throw runtime_error();
+	}
+	/**
+	 * map an image written by save() read-only into memory and serve it in place.
+	 * the file must not be modified while the returned map is alive.
+	 * throw runtime_error if the file cannot be mapped or was not written by
+	 *   save() for this Key and T on a machine of the same byte order.
+	 */
+	static frozen_map load_mmap(const char *path) {
+		static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value,
+			"only trivially copyable keys and values can be mapped");
+#ifdef SJTU_FROZEN_MAP_MMAP
+		int fd = ::open(path, O_RDONLY);
+		if (fd < 0) throw runtime_error();
+		struct stat st;
+		if (::fstat(fd, &st) != 0 || (size_t)st.st_size < page_size) {
+			::close(fd);
+			throw runtime_error();
+		}
+		size_t length = (size_t)st.st_size;
+		void *base = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (base == MAP_FAILED) throw runtime_error();
+		file_header h, expect;
+		std::memcpy(&h, base, sizeof(h));
+		expect = header_for((size_t)h.count);
+		if (std::memcmp(&h, &expect, sizeof(h)) != 0 || h.length != length) {
+			::munmap(base, length);
+			throw runtime_error();
+		}
+		frozen_map res;
+		res.mapping = base;
+		res.mapping_length = length;
+		res.num = (size_t)h.count;
+		res.keys = reinterpret_cast<Key *>(static_cast<char *>(base) + h.keys_offset);
+		res.vals = reinterpret_cast<T *>(static_cast<char *>(base) + h.values_offset);
+		return res;
+#else
+		throw runtime_error();
+#endif
+	}
+private:
+	static bool write_padding(FILE *f, size_t n, const unsigned char *zeros) {
+		for (; n > 0; ) {
+			size_t chunk = n < page_size ? n : page_size;
+			if (std::fwrite(zeros, 1, chunk, f) != chunk) return false;
+			n -= chunk;
+		}
+		return true;
+	}
+	template<class Iterator>
+	void build(Iterator it) {
+		size_t built = 0;
+		try {
+			keys = static_cast<Key *>(::operator new((num + 1) * sizeof(Key)));
+			vals = static_cast<T *>(::operator new((num + 1) * sizeof(T)));
+			fill(1, it, built);
+		} catch (...) {
+			// slots are filled in order, so walk them the same way to undo.
+			for (size_t k = first_slot(); built > 0; k = next_slot(k), --built) {
+				keys[k].~Key();
+				vals[k].~T();
+			}
+			::operator delete(keys);
+			::operator delete(vals);
+			throw;
+		}
+	}
+};
+
+template<class Key, class T, class Compare, class Augment>
+frozen_map<Key, T, Compare> map<Key, T, Compare, Augment>::freeze() const {
+	return frozen_map<Key, T, Compare>(*this);
+}
+
+template<class Key, class T, class Compare, class Augment>
+void map<Key, T, Compare, Augment>::save(const char *path) const {
+	freeze().save(path);
+}
+
+template<class Key, class T, class Compare, class Augment>
+frozen_map<Key, T, Compare> map<Key, T, Compare, Augment>::load_mmap(const char *path) {
+	return frozen_map<Key, T, Compare>::load_mmap(path);
+}
+
+}
+
+#endif
@@ -7,16 +7,33 @@
 // only for std::less<T>
 #include <functional>
 #include <cstddef>
+#include <utility>
 #include "utility.hpp"
 #include "exceptions.hpp"
+#include "rb_tree.hpp"
 
 namespace sjtu {
 
+template<class Key, class T, class Compare> class frozen_map;
+
+/**
+ * whether std::hash<K> can hash a K, which the hot key cache of map needs.
+ */
+template<class K, class = void>
+struct is_hashable : std::false_type {};
+template<class K>
+struct is_hashable<K, decltype((void)std::hash<K>()(std::declval<const K &>()))> : std::true_type {};
+
+/**
+ * the tree engine lives in rb_tree.hpp; map adds the element access,
+ *   the iterators and the whole-map operations on top of it.
+ */
 template<
 	class Key,
 	class T,
-	class Compare = std::less<Key>
-> class map {
+	class Compare = std::less<Key>,
+	class Augment = no_augment
+> class map : private rb_tree<Key, pair<const Key, T>, key_of_pair<Key, T>, Compare, Augment> {
 public:
 	/**
 	 * the internal type of data.
@@ -24,6 +41,213 @@ public:
 	 * You can use sjtu::map as value_type by typedef.
 	 */
 	typedef pair<const Key, T> value_type;
+private:
+	typedef rb_tree<Key, value_type, key_of_pair<Key, T>, Compare, Augment> tree;
+	using typename tree::node;
+	using typename tree::subtree;
+	using typename tree::summary_type;
+	using typename tree::augmented;
+	using typename tree::batch_counter;
+	using tree::root;
+	using tree::num;
+	using tree::cmp;
+	using tree::header;
+	using tree::reset_header;
+	using tree::create_node;
+	using tree::destroy_node;
+	using tree::destroy_tree;
+	using tree::size_of;
+	using tree::settle;
+	using tree::lift;
+	using tree::summary_of;
+	using tree::touch;
+	using tree::minimum;
+	using tree::maximum;
+	using tree::successor;
+	using tree::predecessor;
+	using tree::next_live;
+	using tree::prev_live;
+	using tree::alive;
+	using tree::select;
+	using tree::position;
+	using tree::node_recycler;
+	using tree::clone_tree;
+	using tree::unlink_node;
+	using tree::erase_node;
+	using tree::insert_position;
+	using tree::place_node;
+	using tree::tombstone;
+	using tree::dead;
+	using tree::lazy;
+	using tree::parallel;
+	using tree::whole;
+	using tree::split_key;
+	using tree::join2;
+	using tree::fork_depth;
+	using tree::union_trees;
+	using tree::intersect_trees;
+	using tree::difference_trees;
+	using tree::adopt;
+	using tree::sort_nodes;
+	using tree::build_balanced;
+	using tree::erase_positions;
+	using tree::index_of;
+	using tree::advance;
+	using tree::lower_bound_node;
+	using tree::upper_bound_node;
+	using tree::rank_of;
+	using tree::range_end;
+	using tree::find_node;
+	using tree::find_nodes;
+	using tree::clear_tree;
+	/**
+	 * the hot key cache, off until set_hot_cache() is called: a direct-mapped
+	 *   table of recently found nodes, indexed by the hash of their key.
+	 * a hit is confirmed with the comparator, so a hash that disagrees with
+	 *   Compare only costs hits. a node is always filed under its own key,
+	 *   so erasing it can clear its slot.
+	 */
+	class hot_cache {
+	private:
+		node **slots;
+		size_t mask;
+	public:
+		hot_cache() : slots(nullptr), mask(0) {}
+		// a copy gets an empty table of the same size: it belongs to other nodes.
+		hot_cache(const hot_cache &other) : slots(nullptr), mask(0) { resize(other.size()); }
+		hot_cache(hot_cache &&other) : slots(other.slots), mask(other.mask) {
+			other.slots = nullptr;
+			other.mask = 0;
+		}
+		hot_cache & operator=(const hot_cache &other) {
+			if (this != &other) resize(other.size());
+			return *this;
+		}
+		hot_cache & operator=(hot_cache &&other) {
+			if (this == &other) return *this;
+			delete[] slots;
+			slots = other.slots;
+			mask = other.mask;
+			other.slots = nullptr;
+			other.mask = 0;
+			return *this;
+		}
+		~hot_cache() { delete[] slots; }
+		bool on() const { return slots != nullptr; }
+		size_t size() const { return slots ? mask + 1 : 0; }
+		/**
+		 * n slots rounded up to a power of two, all empty; 0 frees the table.
+		 */
+		void resize(size_t n) {
+			delete[] slots;
+			slots = nullptr;
+			mask = 0;
+			if (!n) return;
+			size_t cap = 1;
+			while (cap < n) cap *= 2;
+			slots = new node *[cap]();
+			mask = cap - 1;
+		}
+		void clear() {
+			for (size_t i = 0; i < size(); ++i) slots[i] = nullptr;
+		}
+		node *&slot(size_t hash) { return slots[hash & mask]; }
+		node *get(size_t hash) const { return slots[hash & mask]; }
+	};
+	hot_cache hot;
+	/**
+	 * std::hash is the identity for integers, so it is scrambled (splitmix64)
+	 *   as in unordered_map before its low bits pick the slot.
+	 */
+	static size_t hot_hash(const Key &key) {
+		unsigned long long h = std::hash<Key>()(key);
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ULL;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebULL;
+		h ^= h >> 31;
+		return (size_t)h;
+	}
+	node *hot_probe(const Key &key) const { return hot_probe(key, is_hashable<Key>()); }
+	node *hot_probe(const Key &, std::false_type) const { return nullptr; }
+	node *hot_probe(const Key &key, std::true_type) const {
+		if (!hot.on()) return nullptr;
+		node *p = hot.get(hot_hash(key));
+		return p && !cmp(key, p->key()) && !cmp(p->key(), key) ? p : nullptr;
+	}
+	void hot_keep(node *p) { hot_keep(p, is_hashable<Key>()); }
+	void hot_keep(node *, std::false_type) {}
+	void hot_keep(node *p, std::true_type) {
+		if (p && hot.on()) hot.slot(hot_hash(p->key())) = p;
+	}
+	void hot_forget(node *p) { hot_forget(p, is_hashable<Key>()); }
+	void hot_forget(node *, std::false_type) {}
+	void hot_forget(node *p, std::true_type) {
+		if (!hot.on()) return;
+		node *&s = hot.slot(hot_hash(p->key()));
+		if (s == p) s = nullptr;
+	}
+	/**
+	 * find_node through the hot key cache; the non-const one files what it finds.
+	 */
+	node *find_hot(const Key &key) {
+		node *p = hot_probe(key);
+		if (!p) {
+			p = find_node(key);
+			hot_keep(p);
+		}
+		return p;
+	}
+	node *find_hot(const Key &key) const {
+		node *p = hot_probe(key);
+		return p ? p : find_node(key);
+	}
+	/**
+	 * the node with key, and false; or, on a miss, the node make() returns,
+	 *   placed where the one descent that missed key ended, and true.
+	 * make() is only called after the descent, so it may move from key.
+	 */
+	template<class Make>
+	pair<node *, bool> find_or_create(const Key &key, Make make) {
+		node *p = hot_probe(key);
+		if (p) return pair<node *, bool>(p, false);
+		node *parent;
+		bool goes_left;
+		p = insert_position(key, parent, goes_left);
+		bool fresh = !alive(p);
+		if (fresh) {
+			node *x = make();
+			place_node(x, p, parent, goes_left);
+			p = x;
+		}
+		hot_keep(p);
+		return pair<node *, bool>(p, fresh);
+	}
+	template<class OutIt, class Iterator, class Owner>
+	struct batch_writer {
+		OutIt out;
+		Owner owner;
+		void operator()(node *p) { *out++ = Iterator(owner, p); }
+	};
+	/**
+	 * run one of the tree set operations on this map and other, which are
+	 *   both compacted first. the operation consumes the nodes of both; if the
+	 *   comparator throws it has destroyed them all, and both maps are left empty.
+	 */
+	void set_operation(map &other, subtree (tree::*op)(subtree, subtree, int) const) {
+		compact();
+		other.compact();
+		subtree t;
+		try {
+			t = (this->*op)(whole(), other.whole(), fork_depth());
+		} catch (...) {
+			hot.clear();
+			adopt(subtree(), other);
+			throw;
+		}
+		adopt(t, other);
+	}
+public:
 	/**
 	 * see BidirectionalIterator at CppReference for help.
 	 *
@@ -33,163 +257,752 @@ public:
 	 */
 	class const_iterator;
 	class iterator {
+		friend class map;
+		friend class const_iterator;
 	private:
 		/**
-		 * TODO add data members
-		 *   just add whatever you want.
+		 * the map this iterator belongs to, and the node it points at.
+		 * past-the-end is represented by a null node.
 		 */
+		map *owner;
+		node *ptr;
+		iterator(map *owner, node *ptr) : owner(owner), ptr(ptr) {}
 	public:
-		iterator() {
-			// TODO
-		}
-		iterator(const iterator &other) {
-			// TODO
-		}
+		iterator() : owner(nullptr), ptr(nullptr) {}
+		iterator(const iterator &other) : owner(other.owner), ptr(other.ptr) {}
+		iterator & operator=(const iterator &other) = default;
 		/**
 		 * return a new iterator which pointer n-next elements
 		 *   even if there are not enough elements, just return the answer.
 		 * as well as operator-
+		 * both run in O(log n) with the subtree sizes,
+		 *   and throw invalid_iterator when the result is outside [begin, end].
 		 */
+		iterator operator+(const int &n) const {
+			return iterator(owner, advance(owner, ptr, n));
+		}
+		iterator operator-(const int &n) const {
+			return iterator(owner, advance(owner, ptr, -n));
+		}
+		// return the distance between two iterators,
+		// if these two iterators points to different maps, throw invaild_iterator.
+		int operator-(const iterator &rhs) const {
+			if (!owner || owner != rhs.owner) throw invalid_iterator();
+			return (int)owner->index_of(ptr) - (int)owner->index_of(rhs.ptr);
+		}
+		iterator & operator+=(const int &n) {
+			ptr = advance(owner, ptr, n);
+			return *this;
+		}
+		iterator & operator-=(const int &n) {
+			ptr = advance(owner, ptr, -n);
+			return *this;
+		}
 		/**
-		 * TODO iter++
+		 * iter++
 		 */
-		iterator operator++(int) {}
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
 		/**
-		 * TODO ++iter
+		 * ++iter
 		 */
-		iterator & operator++() {}
+		iterator & operator++() {
+			if (!ptr) throw invalid_iterator();
+			ptr = next_live(successor(ptr));
+			return *this;
+		}
 		/**
-		 * TODO iter--
+		 * iter--
 		 */
-		iterator operator--(int) {}
+		iterator operator--(int) {
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
 		/**
-		 * TODO --iter
+		 * --iter
 		 */
-		iterator & operator--() {}
+		iterator & operator--() {
+			// also covers an empty map, where begin() == end().
+			if (!owner || ptr == owner->header.leftmost) throw invalid_iterator();
+			ptr = ptr ? prev_live(predecessor(ptr)) : owner->header.rightmost;
+			return *this;
+		}
 		/**
 		 * a operator to check whether two iterators are same (pointing to the same memory).
 		 */
-		value_type & operator*() const {}
-		bool operator==(const iterator &rhs) const {}
-		bool operator==(const const_iterator &rhs) const {}
+		value_type & operator*() const {
+			if (!ptr) throw invalid_iterator();
+			touch(ptr);
+			return *ptr->valptr();
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
 		/**
 		 * some other operator for iterator.
 		 */
-		bool operator!=(const iterator &rhs) const {}
-		bool operator!=(const const_iterator &rhs) const {}
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 
 		/**
-		 * for the support of it->first. 
+		 * for the support of it->first.
 		 * See <http://kelvinh.github.io/blog/2013/11/20/overloading-of-member-access-operator-dash-greater-than-symbol-in-cpp/> for help.
 		 */
-		value_type* operator->() const noexcept {}
+		value_type* operator->() const noexcept {
+			touch(ptr);
+			return ptr->valptr();
+		}
 	};
 	class const_iterator {
 		// it should has similar member method as iterator.
 		//  and it should be able to construct from an iterator.
+		friend class map;
+		friend class iterator;
 		private:
-			// data members.
+			const map *owner;
+			const node *ptr;
+			const_iterator(const map *owner, const node *ptr) : owner(owner), ptr(ptr) {}
 		public:
-			const_iterator() {
-				// TODO
+			const_iterator() : owner(nullptr), ptr(nullptr) {}
+			const_iterator(const const_iterator &other) : owner(other.owner), ptr(other.ptr) {}
+			const_iterator(const iterator &other) : owner(other.owner), ptr(other.ptr) {}
+			const_iterator & operator=(const const_iterator &other) = default;
+			const_iterator operator+(const int &n) const {
+				return const_iterator(owner, advance(owner, ptr, n));
 			}
-			const_iterator(const const_iterator &other) {
-				// TODO
+			const_iterator operator-(const int &n) const {
+				return const_iterator(owner, advance(owner, ptr, -n));
 			}
-			const_iterator(const iterator &other) {
-				// TODO
+			int operator-(const const_iterator &rhs) const {
+				if (!owner || owner != rhs.owner) throw invalid_iterator();
+				return (int)owner->index_of(ptr) - (int)owner->index_of(rhs.ptr);
 			}
-			// And other methods in iterator.
-			// And other methods in iterator.
-			// And other methods in iterator.
+			const_iterator & operator+=(const int &n) {
+				ptr = advance(owner, ptr, n);
+				return *this;
+			}
+			const_iterator & operator-=(const int &n) {
+				ptr = advance(owner, ptr, -n);
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (!ptr) throw invalid_iterator();
+				ptr = next_live(successor(const_cast<node *>(ptr)));
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				if (!owner || ptr == owner->header.leftmost) throw invalid_iterator();
+				ptr = ptr ? prev_live(predecessor(const_cast<node *>(ptr))) : owner->header.rightmost;
+				return *this;
+			}
+			const value_type & operator*() const {
+				if (!ptr) throw invalid_iterator();
+				return *ptr->valptr();
+			}
+			bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+			bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+			const value_type* operator->() const noexcept { return ptr->valptr(); }
 	};
 	/**
-	 * TODO two constructors
+	 * owns one element taken out of a map by extract().
+	 * the element keeps its node, so it can be handed to insert() of any map
+	 *   of the same type without allocating or copying the value.
+	 * it can be moved but not copied; an empty handle owns nothing.
+	 */
+	class node_type {
+		friend class map;
+	private:
+		node *ptr;
+		explicit node_type(node *ptr) : ptr(ptr) {}
+	public:
+		node_type() : ptr(nullptr) {}
+		node_type(node_type &&other) : ptr(other.ptr) { other.ptr = nullptr; }
+		node_type & operator=(node_type &&other) {
+			if (this == &other) return *this;
+			if (ptr) destroy_node(ptr);
+			ptr = other.ptr;
+			other.ptr = nullptr;
+			return *this;
+		}
+		node_type(const node_type &) = delete;
+		node_type & operator=(const node_type &) = delete;
+		~node_type() {
+			if (ptr) destroy_node(ptr);
+		}
+		bool empty() const { return ptr == nullptr; }
+		explicit operator bool() const { return ptr != nullptr; }
+		/**
+		 * throw invalid_iterator if the handle is empty.
+		 */
+		const Key & key() const {
+			if (!ptr) throw invalid_iterator();
+			return ptr->key();
+		}
+		T & mapped() const {
+			if (!ptr) throw invalid_iterator();
+			return ptr->valptr()->second;
+		}
+	};
+	/**
+	 * the result of insert(node_type &&):
+	 *   position is the inserted element, or the one that prevented the insertion,
+	 *   in which case node still owns the element handed in.
+	 */
+	struct insert_return_type {
+		iterator position;
+		bool inserted;
+		node_type node;
+	};
+	/**
+	 * two constructors
 	 */
 	map() {}
-	map(const map &other) {}
 	/**
-	 * TODO assignment operator
+	 * copies the tree shape node by node in O(n), no comparison is made.
+	 */
+	map(const map &other) : tree(other), hot(other.hot) {}
+	/**
+	 * takes over the nodes of other, which is left empty.
+	 * iterators into other are invalidated.
 	 */
-	map & operator=(const map &other) {}
+	map(map &&other) : tree(std::move(other)), hot(std::move(other.hot)) {}
 	/**
-	 * TODO Destructors
+	 * assignment operator
+	 * the nodes already owned by this map are reused for the copy.
+	 * the hot key cache is emptied first: if copying a value throws, the map
+	 *   is left empty and its cache must not point at the recycled nodes.
 	 */
-	~map() {}
+	map & operator=(const map &other) {
+		if (this == &other) return *this;
+		hot.clear();
+		tree::operator=(other);
+		hot = other.hot;
+		return *this;
+	}
+	map & operator=(map &&other) {
+		tree::operator=(std::move(other));
+		hot = std::move(other.hot);
+		return *this;
+	}
 	/**
-	 * TODO
 	 * access specified element with bounds checking
 	 * Returns a reference to the mapped value of the element with key equivalent to key.
 	 * If no such element exists, an exception of type `index_out_of_bound'
 	 */
-	T & at(const Key &key) {}
-	const T & at(const Key &key) const {}
+	T & at(const Key &key) {
+		node *p = find_hot(key);
+		if (!p) throw index_out_of_bound();
+		touch(p);
+		return p->valptr()->second;
+	}
+	const T & at(const Key &key) const {
+		const node *p = find_hot(key);
+		if (!p) throw index_out_of_bound();
+		return p->valptr()->second;
+	}
 	/**
-	 * TODO
-	 * access specified element 
+	 * access specified element
 	 * Returns a reference to the value that is mapped to a key equivalent to key,
 	 *   performing an insertion if such key does not already exist.
+	 * a miss inserts where the lookup ended, so the tree is descended once.
+	 */
+	T & operator[](const Key &key) {
+		node *p = find_or_create(key, [&] { return create_node(key, T()); }).first;
+		touch(p);
+		return p->valptr()->second;
+	}
+	/**
+	 * the key is moved into the new element if one is inserted.
 	 */
-	T & operator[](const Key &key) {}
+	T & operator[](Key &&key) {
+		node *p = find_or_create(key, [&] { return create_node(std::move(key), T()); }).first;
+		touch(p);
+		return p->valptr()->second;
+	}
 	/**
 	 * behave like at() throw index_out_of_bound if such key does not exist.
 	 */
-	const T & operator[](const Key &key) const {}
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
 	/**
 	 * return a iterator to the beginning
 	 */
-	iterator begin() {}
-	const_iterator cbegin() const {}
+	iterator begin() { return iterator(this, header.leftmost); }
+	const_iterator cbegin() const { return const_iterator(this, header.leftmost); }
 	/**
 	 * return a iterator to the end
 	 * in fact, it returns past-the-end.
 	 */
-	iterator end() {}
-	const_iterator cend() const {}
+	iterator end() { return iterator(this, nullptr); }
+	const_iterator cend() const { return const_iterator(this, nullptr); }
 	/**
 	 * checks whether the container is empty
 	 * return true if empty, otherwise false.
 	 */
-	bool empty() const {}
+	bool empty() const { return num == 0; }
 	/**
 	 * returns the number of elements.
 	 */
-	size_t size() const {}
+	size_t size() const { return num; }
 	/**
 	 * clears the contents
 	 */
-	void clear() {}
+	void clear() {
+		clear_tree();
+		hot.clear();
+	}
 	/**
 	 * insert an element.
 	 * return a pair, the first of the pair is
-	 *   the iterator to the new element (or the element that prevented the insertion), 
+	 *   the iterator to the new element (or the element that prevented the insertion),
 	 *   the second one is true if insert successfully, or false.
 	 */
-	pair<iterator, bool> insert(const value_type &value) {}
+	pair<iterator, bool> insert(const value_type &value) {
+		pair<node *, bool> r = find_or_create(value.first, [&] { return create_node(value); });
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
+	/**
+	 * as above, but the mapped value is moved into the new element.
+	 * the key is const in value_type and is therefore still copied;
+	 *   operator[](Key &&) moves the key as well.
+	 */
+	pair<iterator, bool> insert(value_type &&value) {
+		pair<node *, bool> r = find_or_create(value.first, [&] { return create_node(std::move(value)); });
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
+	/**
+	 * find key, or insert it mapped to factory() if it is not there:
+	 *   factory is only called on a miss, after the one descent that missed,
+	 *   so an expensive value is never built in vain.
+	 * returns the same pair as insert().
+	 */
+	template<class Factory>
+	pair<iterator, bool> find_or_emplace(const Key &key, Factory factory) {
+		pair<node *, bool> r = find_or_create(key, [&] { return create_node(key, factory()); });
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
 	/**
 	 * erase the element at pos.
+	 * in lazy erase mode its node is left behind as a tombstone instead.
 	 *
 	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
 	 */
-	void erase(iterator pos) {}
+	void erase(iterator pos) {
+		if (pos.owner != this || !pos.ptr) throw invalid_iterator();
+		hot_forget(pos.ptr);
+		if (lazy) tombstone(pos.ptr);
+		else erase_node(pos.ptr);
+	}
+	/**
+	 * unlink the element at pos and hand it over, without destroying it.
+	 *
+	 * throw invalid_iterator if pos == this->end() or pos is not an iterator of this map.
+	 */
+	node_type extract(iterator pos) {
+		if (pos.owner != this || !pos.ptr) throw invalid_iterator();
+		hot_forget(pos.ptr);
+		unlink_node(pos.ptr);
+		return node_type(pos.ptr);
+	}
+	/**
+	 * returns an empty handle if there is no such key.
+	 */
+	node_type extract(const Key &key) {
+		node *p = find_node(key);
+		if (p) {
+			hot_forget(p);
+			unlink_node(p);
+		}
+		return node_type(p);
+	}
+	/**
+	 * link the element owned by nh into this map if its key is not present yet.
+	 * nothing is allocated or copied either way.
+	 */
+	insert_return_type insert(node_type &&nh) {
+		insert_return_type res;
+		if (!nh.ptr) {
+			res.position = end();
+			res.inserted = false;
+			return res;
+		}
+		node *parent;
+		bool goes_left;
+		node *p = insert_position(nh.ptr->key(), parent, goes_left);
+		if (alive(p)) {
+			res.position = iterator(this, p);
+			res.inserted = false;
+			res.node = std::move(nh);
+			return res;
+		}
+		node *x = nh.ptr;
+		nh.ptr = nullptr;
+		place_node(x, p, parent, goes_left);
+		p = x;
+		res.position = iterator(this, p);
+		res.inserted = true;
+		return res;
+	}
+	/**
+	 * move every element of source whose key is not in this map yet over here.
+	 * the nodes are relinked, so references to the moved elements stay valid
+	 *   (but now belong to this map), and the rest stays in source.
+	 */
+	void merge(map &source) {
+		if (this == &source) return;
+		node *p = source.header.leftmost;
+		while (p) {
+			node *next = next_live(successor(p)), *parent;
+			bool goes_left;
+			node *found = insert_position(p->key(), parent, goes_left);
+			if (!alive(found)) {
+				source.hot_forget(p);
+				source.unlink_node(p);
+				place_node(p, found, parent, goes_left);
+			}
+			p = next;
+		}
+	}
+	/**
+	 * set operations by splitting and joining trees instead of inserting
+	 *   element by element: O(m log(n / m + 1)) work for sizes m <= n,
+	 *   spread over the cores when both maps are large and set_parallel() is on.
+	 * other is taken by value, so pass std::move(m) to hand over its nodes
+	 *   without copying; they are then relinked into this map or destroyed.
+	 * both maps are compacted first if they hold tombstones.
+	 * if the comparator throws, this map is left empty.
+	 *
+	 * union_with adds the elements of other whose key is not in this map.
+	 */
+	void union_with(map other) {
+		set_operation(other, &map::union_trees);
+	}
+	/**
+	 * keep only the elements whose key is also in other.
+	 */
+	void intersect_with(map other) {
+		hot.clear();
+		set_operation(other, &map::intersect_trees);
+	}
+	/**
+	 * remove the elements whose key is in other.
+	 */
+	void difference(map other) {
+		hot.clear();
+		set_operation(other, &map::difference_trees);
+	}
+	/**
+	 * insert the elements of [first, last), which need not be sorted.
+	 * like insert(value), an element whose key is already present is skipped,
+	 *   and of several elements with equal keys in the range the first one wins.
+	 * the new nodes are sorted and linked into a balanced tree (in parallel
+	 *   with set_parallel()), and the tree is then united with this map.
+	 */
+	template<class InputIt>
+	void insert(InputIt first, InputIt last) {
+		size_t n = 0, capacity = 16;
+		node **buf = static_cast<node **>(::operator new(capacity * sizeof(node *))), **sorted = nullptr;
+		try {
+			for (; first != last; ++first) {
+				if (n == capacity) {
+					node **bigger = static_cast<node **>(::operator new(2 * capacity * sizeof(node *)));
+					for (size_t i = 0; i < n; ++i) bigger[i] = buf[i];
+					::operator delete(buf);
+					buf = bigger;
+					capacity *= 2;
+				}
+				buf[n] = create_node(*first);
+				++n;
+			}
+			// a throwing comparator can scramble the array being sorted, so buf is kept.
+			sorted = static_cast<node **>(::operator new(n * sizeof(node *)));
+			std::copy(buf, buf + n, sorted);
+			sort_nodes(sorted, n, fork_depth());
+		} catch (...) {
+			for (size_t i = 0; i < n; ++i) destroy_node(buf[i]);
+			::operator delete(buf);
+			::operator delete(sorted);
+			throw;
+		}
+		::operator delete(buf);
+		buf = sorted;
+		size_t kept = 0;
+		for (size_t i = 0; i < n; ++i) {
+			if (kept && !cmp(buf[kept - 1]->key(), buf[i]->key())) destroy_node(buf[i]);
+			else buf[kept++] = buf[i];
+		}
+		int red_depth = 0;
+		while (((size_t)2 << red_depth) <= kept + 1) ++red_depth;
+		map built;
+		built.root = build_balanced(buf, kept, nullptr, 0, red_depth, fork_depth());
+		::operator delete(buf);
+		union_with(std::move(built));
+	}
+	/**
+	 * erase the elements in [first, last).
+	 * the range is cut out of the tree with two splits and one join,
+	 *   so it costs O(log n) plus the destruction of the erased elements.
+	 *
+	 * the tombstones are compacted away first, even in lazy erase mode.
+	 *
+	 * throw invalid_iterator if first or last is not an iterator of this map,
+	 *   or if first comes after last.
+	 */
+	void erase(iterator first, iterator last) {
+		if (first.owner != this || last.owner != this) throw invalid_iterator();
+		size_t a = index_of(first.ptr), b = index_of(last.ptr);
+		if (a > b) throw invalid_iterator();
+		hot.clear();
+		compact();
+		erase_positions(a, b);
+	}
+	/**
+	 * lazy erase mode, for erase-heavy phases: erase(pos) then only marks the
+	 *   element as a tombstone in O(log n), without a single rotation.
+	 * tombstones are invisible: size(), lookups, iteration, nth, rank and
+	 *   aggregate skip them, and inserting the key again reuses the node.
+	 * once they outnumber the elements, the erase that tips the balance
+	 *   rebuilds the tree without them in O(n), which the erases before it
+	 *   pay for, so lookups never descend more than one extra level.
+	 * iterators to the remaining elements stay valid through the compaction.
+	 * switching the mode off compacts at once.
+	 */
+	void set_lazy_erase(bool on) {
+		lazy = on;
+		if (!on) compact();
+	}
+	bool lazy_erase() const { return lazy; }
 	/**
-	 * Returns the number of elements with key 
+	 * let union_with, intersect_with, difference and insert(first, last) fork
+	 *   onto other threads when the operands hold parallel_grain elements or more.
+	 * it is off by default: the comparator, and the destructors of the elements
+	 *   dropped, then run on several threads at once, so they must not touch
+	 *   shared state without synchronization (an instance counter, say).
+	 * copies of the map inherit the setting.
+	 */
+	void set_parallel(bool on) { parallel = on; }
+	bool parallel_ops() const { return parallel; }
+	/**
+	 * the number of tombstones currently left in the tree.
+	 */
+	size_t tombstones() const { return dead; }
+	/**
+	 * drop the tombstones now, in O(n) time and without allocating.
+	 */
+	void compact() { tree::compact(); }
+	/**
+	 * self-adjusting lookups for skewed key distributions: remember the node
+	 *   last found in each of `slots' (rounded up to a power of two) hash
+	 *   buckets, so that find, at, count and operator[] on a hot key cost a
+	 *   hash and two comparisons instead of a descent through log n nodes.
+	 * non-const lookups refresh the table and const ones only read it,
+	 *   so concurrent const lookups remain safe.
+	 * Key must be hashable by std::hash; 0 switches the cache off and frees it.
+	 * a copy of the map gets an empty cache of the same size.
+	 */
+	void set_hot_cache(size_t slots) {
+		static_assert(is_hashable<Key>::value, "the hot key cache needs std::hash<Key>");
+		hot.resize(slots);
+	}
+	size_t hot_cache_size() const { return hot.size(); }
+	/**
+	 * Returns the number of elements with key
 	 *   that compares equivalent to the specified argument,
-	 *   which is either 1 or 0 
+	 *   which is either 1 or 0
 	 *     since this container does not allow duplicates.
 	 * The default method of check the equivalence is !(a < b || b > a)
 	 */
-	size_t count(const Key &key) const {}
+	size_t count(const Key &key) const { return find_hot(key) ? 1 : 0; }
 	/**
 	 * Finds an element with key equivalent to key.
 	 * key value of the element to search for.
 	 * Iterator to an element with key equivalent to key.
 	 *   If no such element is found, past-the-end (see end()) iterator is returned.
 	 */
-	iterator find(const Key &key) {}
-	const_iterator find(const Key &key) const {}
+	iterator find(const Key &key) { return iterator(this, find_hot(key)); }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_hot(key)); }
+	/**
+	 * find every key of [first, last) and write the results (end() for a miss)
+	 *   to out in the same order, returning out past the last one written.
+	 * the searches are interleaved with software prefetching, which hides
+	 *   most of the memory latency when the map does not fit in the cache.
+	 * KeyIt has to be a forward iterator yielding const Key &.
+	 */
+	template<class KeyIt, class OutIt>
+	OutIt find_batch(KeyIt first, KeyIt last, OutIt out) {
+		batch_writer<OutIt, iterator, map *> writer = {out, this};
+		find_nodes(first, last, writer);
+		return writer.out;
+	}
+	template<class KeyIt, class OutIt>
+	OutIt find_batch(KeyIt first, KeyIt last, OutIt out) const {
+		batch_writer<OutIt, const_iterator, const map *> writer = {out, this};
+		find_nodes(first, last, writer);
+		return writer.out;
+	}
+	/**
+	 * returns how many keys of [first, last) are in the map, searching like find_batch.
+	 */
+	template<class KeyIt>
+	size_t count_batch(KeyIt first, KeyIt last) const {
+		batch_counter counter = {0};
+		find_nodes(first, last, counter);
+		return counter.hits;
+	}
+	/**
+	 * returns an iterator to the first element whose key is not less than key,
+	 *   or end() if there is no such element.
+	 */
+	iterator lower_bound(const Key &key) { return iterator(this, lower_bound_node(key)); }
+	const_iterator lower_bound(const Key &key) const { return const_iterator(this, lower_bound_node(key)); }
+	/**
+	 * returns an iterator to the first element whose key is greater than key,
+	 *   or end() if there is no such element.
+	 */
+	iterator upper_bound(const Key &key) { return iterator(this, upper_bound_node(key)); }
+	const_iterator upper_bound(const Key &key) const { return const_iterator(this, upper_bound_node(key)); }
+	/**
+	 * returns the range of elements with key equivalent to key,
+	 *   as a pair of lower_bound(key) and upper_bound(key).
+	 */
+	pair<iterator, iterator> equal_range(const Key &key) {
+		node *lo = lower_bound_node(key);
+		return pair<iterator, iterator>(iterator(this, lo), iterator(this, range_end(lo, key)));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+		node *lo = lower_bound_node(key);
+		return pair<const_iterator, const_iterator>(const_iterator(this, lo), const_iterator(this, range_end(lo, key)));
+	}
+	/**
+	 * returns an iterator to the k-th (0-based) element in key order,
+	 *   or end() if k >= size().
+	 */
+	iterator nth(size_t k) { return iterator(this, select(root, k)); }
+	const_iterator nth(size_t k) const { return const_iterator(this, select(root, k)); }
+	/**
+	 * returns the number of elements whose key is less than key.
+	 */
+	size_t rank(const Key &key) const { return rank_of(key); }
+	/**
+	 * combine the Augment summaries of the elements with lo <= key < hi in key order;
+	 *   Augment::identity() if the range is empty.
+	 * values written through *, ->, at() or operator[] only mark the summaries
+	 *   above them stale, and aggregate() recomputes those first, so it is not
+	 *   const. each stale mark is set once by such an access and cleared once
+	 *   here, so a call costs O(log n) amortized over the accesses before it:
+	 *   after a mutable pass over the whole map the next call takes O(n).
+	 * the mark is set when the reference is handed out, not when it is written:
+	 *   a reference or pointer kept across aggregate() must not be written
+	 *   through without fetching the value again by one of those accesses,
+	 *   or the write is missed by every later aggregate().
+	 */
+	summary_type aggregate(const Key &lo, const Key &hi) {
+		static_assert(augmented::value, "aggregate() needs an Augment");
+		settle(root);
+		node *p = root;
+		while (p) {
+			if (!cmp(p->key(), hi)) p = p->left;
+			else if (cmp(p->key(), lo)) p = p->right;
+			else break;
+		}
+		if (!p) return Augment::identity();
+		// p is the highest node in the range: collect the part of the range
+		//   on either side of it while descending towards lo and towards hi.
+		summary_type left = Augment::identity(), right = Augment::identity();
+		for (node *q = p->left; q; ) {
+			if (cmp(q->key(), lo)) {
+				q = q->right;
+			} else {
+				left = Augment::combine(Augment::combine(lift(q), summary_of(q->right)), left);
+				q = q->left;
+			}
+		}
+		for (node *q = p->right; q; ) {
+			if (cmp(q->key(), hi)) {
+				right = Augment::combine(right, Augment::combine(summary_of(q->left), lift(q)));
+				q = q->right;
+			} else {
+				q = q->left;
+			}
+		}
+		return Augment::combine(Augment::combine(left, lift(p)), right);
+	}
+	/**
+	 * heterogeneous lookup, enabled only when Compare::is_transparent names a type
+	 *   (e.g. std::less<> for std::string keys probed with a std::string_view).
+	 * the probe is handed to the comparator as is; no Key is constructed.
+	 */
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	T & at(const K &key) {
+		node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		touch(p);
+		return p->valptr()->second;
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const T & at(const K &key) const {
+		const node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		return p->valptr()->second;
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	size_t count(const K &key) const { return find_node(key) ? 1 : 0; }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	iterator find(const K &key) { return iterator(this, find_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const_iterator find(const K &key) const { return const_iterator(this, find_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	iterator lower_bound(const K &key) { return iterator(this, lower_bound_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const_iterator lower_bound(const K &key) const { return const_iterator(this, lower_bound_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	iterator upper_bound(const K &key) { return iterator(this, upper_bound_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	const_iterator upper_bound(const K &key) const { return const_iterator(this, upper_bound_node(key)); }
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	pair<iterator, iterator> equal_range(const K &key) {
+		node *lo = lower_bound_node(key);
+		return pair<iterator, iterator>(iterator(this, lo), iterator(this, range_end(lo, key)));
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		node *lo = lower_bound_node(key);
+		return pair<const_iterator, const_iterator>(const_iterator(this, lo), const_iterator(this, range_end(lo, key)));
+	}
+	template<class K, class C = Compare, class = typename C::is_transparent>
+	size_t rank(const K &key) const { return rank_of(key); }
+	/**
+	 * returns a read-only copy of the map laid out for fast lookups.
+	 * later changes to *this are not reflected in it.
+	 * defined in frozen_map.hpp, which has to be included to call it.
+	 */
+	frozen_map<Key, T, Compare> freeze() const;
+	/**
+	 * write a sorted, page-aligned image of the map to path, and map such an
+	 *   image back as a read-only frozen_map without deserializing it.
+	 * Key and T must be trivially copyable; see frozen_map::save for the format.
+	 * both are defined in frozen_map.hpp, which has to be included to call them.
+	 */
+	void save(const char *path) const;
+	static frozen_map<Key, T, Compare> load_mmap(const char *path);
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,104 @@
+/**
+ * implement a container like std::multimap
+ */
+#ifndef SJTU_MULTIMAP_HPP
+#define SJTU_MULTIMAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "rb_tree.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered map which keeps every element inserted, on the tree engine of
+ *   sjtu::map: the elements with equal keys sit next to each other in the
+ *   order they were inserted, each in a node of its own.
+ * count() and erase(key) take O(log n) (plus the erased nodes) thanks to
+ *   the subtree sizes, however many elements share the key.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class multimap : private rb_tree<Key, pair<const Key, T>, key_of_pair<Key, T>, Compare> {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	typedef rb_tree<Key, value_type, key_of_pair<Key, T>, Compare> tree;
+	using typename tree::node;
+	using tree::num;
+	using tree::cmp;
+	using tree::header;
+	using tree::create_node;
+	using tree::insert_position_multi;
+	using tree::link_node;
+	using tree::erase_node;
+	using tree::lower_bound_node;
+	using tree::upper_bound_node;
+	using tree::count_equal;
+	using tree::erase_equal;
+	using tree::iterator_to;
+	using tree::const_iterator_to;
+	using tree::node_at;
+	using tree::clear_tree;
+	node *find_first(const Key &key) const {
+		node *p = lower_bound_node(key);
+		return p && !cmp(key, p->key()) ? p : nullptr;
+	}
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef typename tree::template basic_iterator<false> iterator;
+	typedef typename tree::template basic_iterator<true> const_iterator;
+
+	iterator begin() { return iterator_to(header.leftmost); }
+	const_iterator cbegin() const { return const_iterator_to(header.leftmost); }
+	iterator end() { return iterator_to(nullptr); }
+	const_iterator cend() const { return const_iterator_to(nullptr); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	void clear() { clear_tree(); }
+	/**
+	 * insert value after the elements with an equal key; returns an iterator to it.
+	 */
+	iterator insert(const value_type &value) {
+		node *parent;
+		bool goes_left;
+		insert_position_multi(value.first, parent, goes_left);
+		node *p = create_node(value);
+		link_node(p, parent, goes_left);
+		return iterator_to(p);
+	}
+	/**
+	 * throw invalid_iterator if pos is end() or belongs to another multimap.
+	 */
+	void erase(iterator pos) { erase_node(node_at(pos)); }
+	/**
+	 * erase every element with key; returns how many there were.
+	 */
+	size_t erase(const Key &key) { return erase_equal(key); }
+	size_t count(const Key &key) const { return count_equal(key); }
+	/**
+	 * the first element with key, or end().
+	 */
+	iterator find(const Key &key) { return iterator_to(find_first(key)); }
+	const_iterator find(const Key &key) const { return const_iterator_to(find_first(key)); }
+	iterator lower_bound(const Key &key) { return iterator_to(lower_bound_node(key)); }
+	const_iterator lower_bound(const Key &key) const { return const_iterator_to(lower_bound_node(key)); }
+	iterator upper_bound(const Key &key) { return iterator_to(upper_bound_node(key)); }
+	const_iterator upper_bound(const Key &key) const { return const_iterator_to(upper_bound_node(key)); }
+	pair<iterator, iterator> equal_range(const Key &key) {
+		return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+		return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+	}
+};
+
+}
+
+#endif
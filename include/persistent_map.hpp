@@ -0,0 +1,404 @@
+/**
+ * an immutable, path-copying variant of sjtu::map
+ */
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * every persistent_map object is one immutable version of the map.
+ * insert() and erase() leave *this untouched and return a new version
+ *   which shares all nodes off the modified path with the old one,
+ *   so a change costs O(log n) node allocations.
+ * nodes are reference counted atomically: copying a version is O(1),
+ *   and a version can be read from any number of threads without locks
+ *   while other threads derive new versions from it.
+ *
+ * the tree is weight-balanced (delta = 3, ratio = 2), which keeps
+ *   insert and erase purely recursive and gives subtree sizes for free.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class persistent_map {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	struct node {
+		mutable std::atomic<size_t> refs;
+		node *left, *right;
+		size_t sz;
+		value_type val;
+		node(const value_type &val, node *left, node *right)
+			: refs(1), left(left), right(right), sz(size_of(left) + size_of(right) + 1), val(val) {}
+	};
+
+	node *root;
+	Compare cmp;
+
+	static const size_t delta = 3;
+	static const size_t ratio = 2;
+
+	static size_t size_of(const node *p) { return p ? p->sz : 0; }
+	static node *retain(node *p) {
+		if (p) p->refs.fetch_add(1, std::memory_order_relaxed);
+		return p;
+	}
+	static void release(node *p) {
+		while (p && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			release(p->left);
+			node *r = p->right;
+			delete p;
+			p = r;
+		}
+	}
+	/**
+	 * the building blocks below take ownership of the references passed in
+	 *   as l, r or t, and return an owned reference.
+	 */
+	static node *make(const value_type &val, node *l, node *r) {
+		try {
+			return new node(val, l, r);
+		} catch (...) {
+			release(l);
+			release(r);
+			throw;
+		}
+	}
+	static node *rotate_left(const value_type &val, node *l, node *r) {
+		node *rl = r->left, *rr = r->right, *res;
+		try {
+			if (size_of(rl) < ratio * size_of(rr)) {
+				node *nl = make(val, l, retain(rl));
+				res = make(r->val, nl, retain(rr));
+			} else {
+				node *nl = make(val, l, retain(rl->left));
+				node *nr = make(r->val, retain(rl->right), retain(rr));
+				res = make(rl->val, nl, nr);
+			}
+		} catch (...) {
+			release(r);
+			throw;
+		}
+		release(r);
+		return res;
+	}
+	static node *rotate_right(const value_type &val, node *l, node *r) {
+		node *ll = l->left, *lr = l->right, *res;
+		try {
+			if (size_of(lr) < ratio * size_of(ll)) {
+				node *nr = make(val, retain(lr), r);
+				res = make(l->val, retain(ll), nr);
+			} else {
+				node *nl = make(l->val, retain(ll), retain(lr->left));
+				node *nr = make(val, retain(lr->right), r);
+				res = make(lr->val, nl, nr);
+			}
+		} catch (...) {
+			release(l);
+			throw;
+		}
+		release(l);
+		return res;
+	}
+	/**
+	 * build a node from val, l and r, restoring the weight balance
+	 *   after one of the sides grew or shrank by a single element.
+	 */
+	static node *balance(const value_type &val, node *l, node *r) {
+		size_t ls = size_of(l), rs = size_of(r);
+		if (ls + rs <= 1) return make(val, l, r);
+		if (rs > delta * ls) return rotate_left(val, l, r);
+		if (ls > delta * rs) return rotate_right(val, l, r);
+		return make(val, l, r);
+	}
+	/**
+	 * returns an owned reference to the new subtree,
+	 *   or null if the key is already in t (t is not consumed).
+	 */
+	node *insert_node(const node *t, const value_type &value) const {
+		if (!t) return make(value, nullptr, nullptr);
+		if (cmp(value.first, t->val.first)) {
+			node *l = insert_node(t->left, value);
+			return l ? balance(t->val, l, retain(t->right)) : nullptr;
+		}
+		if (cmp(t->val.first, value.first)) {
+			node *r = insert_node(t->right, value);
+			return r ? balance(t->val, retain(t->left), r) : nullptr;
+		}
+		return nullptr;
+	}
+	/**
+	 * remove the minimum of the owned tree t.
+	 * the removed node is handed back retained through min.
+	 */
+	static node *erase_min(node *t, node *&min) {
+		node *res;
+		try {
+			if (!t->left) {
+				min = retain(t);
+				res = retain(t->right);
+			} else {
+				node *l = erase_min(retain(t->left), min);
+				res = balance(t->val, l, retain(t->right));
+			}
+		} catch (...) {
+			release(t);
+			throw;
+		}
+		release(t);
+		return res;
+	}
+	static node *erase_max(node *t, node *&max) {
+		node *res;
+		try {
+			if (!t->right) {
+				max = retain(t);
+				res = retain(t->left);
+			} else {
+				node *r = erase_max(retain(t->right), max);
+				res = balance(t->val, retain(t->left), r);
+			}
+		} catch (...) {
+			release(t);
+			throw;
+		}
+		release(t);
+		return res;
+	}
+	/**
+	 * concatenate two owned trees of a removed node.
+	 */
+	static node *glue(node *l, node *r) {
+		if (!l) return r;
+		if (!r) return l;
+		node *m = nullptr, *res;
+		try {
+			if (size_of(l) > size_of(r)) {
+				try {
+					l = erase_max(l, m);
+				} catch (...) {
+					release(r);
+					throw;
+				}
+			} else {
+				try {
+					r = erase_min(r, m);
+				} catch (...) {
+					release(l);
+					throw;
+				}
+			}
+			res = balance(m->val, l, r);
+		} catch (...) {
+			release(m);
+			throw;
+		}
+		release(m);
+		return res;
+	}
+	/**
+	 * returns an owned reference to t without key through result,
+	 *   false if key is not in t.
+	 */
+	bool erase_node(const node *t, const Key &key, node *&result) const {
+		if (!t) return false;
+		if (cmp(key, t->val.first)) {
+			node *l;
+			if (!erase_node(t->left, key, l)) return false;
+			result = balance(t->val, l, retain(t->right));
+		} else if (cmp(t->val.first, key)) {
+			node *r;
+			if (!erase_node(t->right, key, r)) return false;
+			result = balance(t->val, retain(t->left), r);
+		} else {
+			result = glue(retain(t->left), retain(t->right));
+		}
+		return true;
+	}
+	const node *find_node(const Key &key) const {
+		const node *p = root;
+		while (p) {
+			if (cmp(key, p->val.first)) p = p->left;
+			else if (cmp(p->val.first, key)) p = p->right;
+			else return p;
+		}
+		return nullptr;
+	}
+	persistent_map(node *root, const Compare &cmp) : root(root), cmp(cmp) {}
+public:
+	/**
+	 * a bidirectional iterator into one version.
+	 * it keeps the path from the root down to its element, so ++ and --
+	 *   take amortized O(1) steps without parent links; a child holds at most
+	 *   3/4 of its parent's elements, so the path is shorter than max_depth.
+	 * it holds a reference to the root of its version, so it stays valid
+	 *   even after every persistent_map object of that version is gone;
+	 *   copying one copies its path.
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 */
+	class const_iterator {
+		friend class persistent_map;
+	private:
+		static const int max_depth = 8 * sizeof(size_t) * 5 / 2;
+		node *root;
+		int depth;
+		const node *path[max_depth];
+		/**
+		 * end() has an empty path; otherwise path[depth - 1] is the element.
+		 */
+		explicit const_iterator(node *root) : root(retain(root)), depth(0) {}
+		void push_leftmost(const node *p) {
+			for (; p; p = p->left) path[depth++] = p;
+		}
+		void push_rightmost(const node *p) {
+			for (; p; p = p->right) path[depth++] = p;
+		}
+		void copy_path(const const_iterator &other) {
+			depth = other.depth;
+			for (int i = 0; i < depth; ++i) path[i] = other.path[i];
+		}
+	public:
+		const_iterator() : root(nullptr), depth(0) {}
+		const_iterator(const const_iterator &other) : root(retain(other.root)) { copy_path(other); }
+		const_iterator & operator=(const const_iterator &other) {
+			node *old = root;
+			root = retain(other.root);
+			copy_path(other);
+			release(old);
+			return *this;
+		}
+		~const_iterator() { release(root); }
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		const_iterator & operator++() {
+			if (!depth) throw invalid_iterator();
+			const node *p = path[depth - 1];
+			if (p->right) {
+				push_leftmost(p->right);
+				return *this;
+			}
+			// climb while coming up from a right child.
+			--depth;
+			while (depth && path[depth - 1]->right == p) p = path[--depth];
+			return *this;
+		}
+		const_iterator operator--(int) {
+			const_iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		const_iterator & operator--() {
+			if (!depth) {
+				if (!root) throw invalid_iterator();
+				push_rightmost(root);
+				return *this;
+			}
+			const node *p = path[depth - 1];
+			if (p->left) {
+				path[depth++] = p->left;
+				push_rightmost(p->left->right);
+				return *this;
+			}
+			// climb while coming up from a left child; at begin() nothing changes.
+			int d = depth - 1;
+			while (d && path[d - 1]->left == p) p = path[--d];
+			if (!d) throw invalid_iterator();
+			depth = d;
+			return *this;
+		}
+		const value_type & operator*() const {
+			if (!depth) throw invalid_iterator();
+			return path[depth - 1]->val;
+		}
+		const value_type* operator->() const noexcept { return &path[depth - 1]->val; }
+		bool operator==(const const_iterator &rhs) const {
+			return root == rhs.root && (depth ? path[depth - 1] : nullptr) == (rhs.depth ? rhs.path[rhs.depth - 1] : nullptr);
+		}
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+	};
+	typedef const_iterator iterator;
+
+	persistent_map() : root(nullptr) {}
+	/**
+	 * O(1): the copy shares every node with other.
+	 */
+	persistent_map(const persistent_map &other) : root(retain(other.root)), cmp(other.cmp) {}
+	persistent_map & operator=(const persistent_map &other) {
+		node *old = root;
+		root = retain(other.root);
+		cmp = other.cmp;
+		release(old);
+		return *this;
+	}
+	~persistent_map() {
+		release(root);
+	}
+	/**
+	 * access specified element with bounds checking.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	const T & at(const Key &key) const {
+		const node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		return p->val.second;
+	}
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	const_iterator begin() const {
+		const_iterator it(root);
+		it.push_leftmost(root);
+		return it;
+	}
+	const_iterator cbegin() const { return begin(); }
+	const_iterator end() const { return const_iterator(root); }
+	const_iterator cend() const { return const_iterator(root); }
+	bool empty() const { return root == nullptr; }
+	size_t size() const { return size_of(root); }
+	/**
+	 * returns a new version containing value as well.
+	 * if the key already exists, the returned version shares the whole tree with *this.
+	 */
+	persistent_map insert(const value_type &value) const {
+		node *r = insert_node(root, value);
+		return r ? persistent_map(r, cmp) : *this;
+	}
+	/**
+	 * returns a new version without key.
+	 * if there is no such key, the returned version shares the whole tree with *this.
+	 */
+	persistent_map erase(const Key &key) const {
+		node *r;
+		return erase_node(root, key, r) ? persistent_map(r, cmp) : *this;
+	}
+	size_t count(const Key &key) const { return find_node(key) ? 1 : 0; }
+	const_iterator find(const Key &key) const {
+		const_iterator it(root);
+		for (const node *p = root; p; ) {
+			it.path[it.depth++] = p;
+			if (cmp(key, p->val.first)) p = p->left;
+			else if (cmp(p->val.first, key)) p = p->right;
+			else return it;
+		}
+		it.depth = 0;
+		return it;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,1475 @@
+/**
+ * the red-black tree shared by sjtu::map, set, multiset and multimap
+ */
+#ifndef SJTU_RB_TREE_HPP
+#define SJTU_RB_TREE_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <thread>
+#include <type_traits>
+#include <string>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * the default Augment of sjtu::map: no summary is kept.
+ *
+ * an Augment keeps a summary of every subtree, which aggregate() combines
+ *   for a key range in O(log n). it is a monoid over the elements:
+ *
+ * struct sum_of_values {
+ *     typedef long long result_type;
+ *     static result_type identity() { return 0; }
+ *     static result_type lift(const Key &key, const T &value) { return value; }
+ *     // associative; need not be commutative, the arguments come in key order.
+ *     static result_type combine(const result_type &a, const result_type &b) { return a + b; }
+ * };
+ */
+struct no_augment {
+	typedef void result_type;
+};
+template<class Augment> struct augment_slot {
+	typename Augment::result_type summary;
+};
+template<> struct augment_slot<no_augment> {};
+
+/**
+ * how the tree finds the key in a value, and hands the value to Augment::lift.
+ */
+template<class Key>
+struct key_of_key {
+	static const Key &key(const Key &value) { return value; }
+	template<class Augment>
+	static typename Augment::result_type lift(const Key &value) { return Augment::lift(value); }
+};
+template<class Key, class T>
+struct key_of_pair {
+	static const Key &key(const pair<const Key, T> &value) { return value.first; }
+	template<class Augment>
+	static typename Augment::result_type lift(const pair<const Key, T> &value) { return Augment::lift(value.first, value.second); }
+};
+
+/**
+ * what a node keeps about its key to speed up the descents; by default nothing.
+ */
+template<class Key, class Compare>
+struct key_cache {
+	void fill(const Key &) {}
+};
+/**
+ * std::string keys ordered by std::less keep their first 8 bytes as a
+ *   big-endian integer, zero padded. wherever two such prefixes differ they
+ *   order the strings as the strings compare, so most comparisons on the way
+ *   down never reach the string's heap buffer.
+ */
+template<>
+struct key_cache<std::string, std::less<std::string> > {
+	uint64_t prefix;
+	void fill(const std::string &key) { prefix = prefix_of(key); }
+	static uint64_t prefix_of(const std::string &key) {
+		uint64_t r = 0;
+		size_t n = key.size() < 8 ? key.size() : 8;
+		for (size_t i = 0; i < n; ++i) r |= (uint64_t)(unsigned char)key[i] << (56 - 8 * i);
+		return r;
+	}
+};
+
+/**
+ * the engine of the ordered containers: a red-black tree of Value ordered by
+ *   KeyOfValue::key(value), with subtree sizes, an optional Augment summary,
+ *   the join-based bulk operations and the batched lookups.
+ * it has no public interface of its own. every container inherits it
+ *   privately, pulls in the parts it needs with using-declarations and
+ *   builds its own iterators on top, so a tweak to the tree reaches all of them.
+ * equal keys are allowed if the container inserts at insert_position_multi.
+ */
+template<
+	class Key,
+	class Value,
+	class KeyOfValue,
+	class Compare = std::less<Key>,
+	class Augment = no_augment
+> class rb_tree {
+protected:
+	typedef Value value_type;
+	/**
+	 * a red-black tree node.
+	 * the value lives in raw storage so that a node can be allocated
+	 * and released independently of the value it carries.
+	 * sz is the number of live nodes in the subtree rooted here, which leaves
+	 *   out the tombstones of map's lazy erase mode.
+	 * the Augment summary of the subtree, if any, lives in the empty-by-default
+	 *   base, so a map without one pays nothing for it; so does the key_cache.
+	 */
+	struct node : augment_slot<Augment>, key_cache<Key, Compare> {
+		node *left, *right;
+		size_t sz;
+		/**
+		 * the parent pointer with the color in its lowest bit (set for red),
+		 *   which is always free since nodes are at least pointer aligned.
+		 * this saves the padded color word: 40 instead of 48 bytes per node
+		 *   for map<int, int> on a 64-bit target.
+		 * the next bit is set while the summary is stale (see touch()),
+		 *   and the third one marks a tombstone (see tombstone()).
+		 */
+		alignas(8) uintptr_t parent_red;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+		node *parent() const { return reinterpret_cast<node *>(parent_red & ~(uintptr_t)7); }
+		void set_parent(node *p) { parent_red = reinterpret_cast<uintptr_t>(p) | (parent_red & 7); }
+		bool red() const { return parent_red & 1; }
+		void set_red(bool red) { parent_red = (parent_red & ~(uintptr_t)1) | (uintptr_t)red; }
+		bool stale() const { return parent_red & 2; }
+		void set_stale(bool stale) { parent_red = (parent_red & ~(uintptr_t)2) | ((uintptr_t)stale << 1); }
+		bool dead() const { return parent_red & 4; }
+		void set_dead(bool dead) { parent_red = (parent_red & ~(uintptr_t)4) | ((uintptr_t)dead << 2); }
+		// sets both at once, for a node whose word holds nothing yet; the summary is then pulled.
+		void set_parent_red(node *p, bool red) { parent_red = reinterpret_cast<uintptr_t>(p) | (uintptr_t)red; }
+		value_type *valptr() { return reinterpret_cast<value_type *>(storage); }
+		const value_type *valptr() const { return reinterpret_cast<const value_type *>(storage); }
+		const Key &key() const { return KeyOfValue::key(*valptr()); }
+	};
+
+	node *root;
+	/**
+	 * num counts the live nodes only; dead counts the tombstones,
+	 *   which are only ever left behind while lazy is set.
+	 */
+	size_t num, dead;
+	bool lazy;
+	/**
+	 * the bulk operations only fork onto other threads while parallel is set,
+	 *   since the comparator and the element destructors then run concurrently.
+	 */
+	bool parallel;
+	Compare cmp;
+	/**
+	 * the sentinel header: the first and the last node in key order,
+	 *   so that stepping off either end of the sequence is caught in O(1).
+	 * end() is still the null node, which keeps ++ as cheap as before.
+	 */
+	struct {
+		node *leftmost, *rightmost;
+	} header;
+
+	/**
+	 * single updates keep header in step as they link and unlink nodes,
+	 *   so begin(), --end(), size() and empty() never walk the tree.
+	 * only the bulk operations, which cost O(log n) or more anyway, look the ends up again.
+	 */
+	void reset_header() {
+		header.leftmost = root ? next_live(minimum(root)) : nullptr;
+		header.rightmost = root ? prev_live(maximum(root)) : nullptr;
+	}
+
+	static node *allocate_node() {
+		return static_cast<node *>(::operator new(sizeof(node)));
+	}
+	static void deallocate_node(node *p) {
+		::operator delete(p);
+	}
+	/**
+	 * construct the value in a new node from args, forwarded as they are.
+	 */
+	template<class... Args>
+	static node *create_node(Args &&... args) {
+		node *p = allocate_node();
+		try {
+			new (p->storage) value_type(std::forward<Args>(args)...);
+		} catch (...) {
+			deallocate_node(p);
+			throw;
+		}
+		p->fill(p->key());
+		return p;
+	}
+	static void destroy_node(node *p) {
+		p->valptr()->~value_type();
+		deallocate_node(p);
+	}
+	static void destroy_tree(node *p) {
+		while (p) {
+			destroy_tree(p->right);
+			node *l = p->left;
+			destroy_node(p);
+			p = l;
+		}
+	}
+
+	static size_t size_of(const node *p) { return p ? p->sz : 0; }
+	static size_t live(const node *p) { return !p->dead(); }
+	static bool alive(const node *p) { return p && !p->dead(); }
+	static void pull(node *p) {
+		p->sz = size_of(p->left) + size_of(p->right) + live(p);
+		pull_summary(p, augmented());
+	}
+	/**
+	 * a node's summary is stale after a mutable reference to one of the values
+	 *   below it was handed out, and the stale bit is then set on every node
+	 *   up to the root. summaries are recomputed from the children on every
+	 *   structural change, and the stale ones are settled by aggregate().
+	 *   a write through a reference kept since before that settle is not seen
+	 *   until the value is handed out mutably again.
+	 */
+	typedef std::integral_constant<bool, !std::is_same<Augment, no_augment>::value> augmented;
+	typedef typename Augment::result_type summary_type;
+	static summary_type lift(const node *p) {
+		return p->dead() ? Augment::identity() : KeyOfValue::template lift<Augment>(*p->valptr());
+	}
+	static summary_type summary_of(const node *p) { return p ? p->summary : Augment::identity(); }
+	static bool stale_of(const node *p) { return p && p->stale(); }
+	static void pull_summary(node *, std::false_type) {}
+	static void pull_summary(node *p, std::true_type) {
+		p->set_stale(stale_of(p->left) || stale_of(p->right));
+		if (!p->stale())
+			p->summary = Augment::combine(Augment::combine(summary_of(p->left), lift(p)), summary_of(p->right));
+	}
+	/**
+	 * give dst the size and the summary of src, whose subtree it takes over.
+	 */
+	static void take_over(node *dst, const node *src) {
+		dst->sz = src->sz;
+		take_over(dst, src, augmented());
+	}
+	static void take_over(node *, const node *, std::false_type) {}
+	static void take_over(node *dst, const node *src, std::true_type) {
+		dst->summary = src->summary;
+		dst->set_stale(src->stale());
+	}
+	/**
+	 * recompute the summaries from p up to the root, after a node below p
+	 *   was added or removed; the sizes are kept up to date by the caller.
+	 */
+	static void pull_path(node *p) { pull_path(p, augmented()); }
+	static void pull_path(node *, std::false_type) {}
+	static void pull_path(node *p, std::true_type) {
+		for (; p; p = p->parent()) pull_summary(p, std::true_type());
+	}
+	static void touch(node *p) { touch(p, augmented()); }
+	static void touch(node *, std::false_type) {}
+	static void touch(node *p, std::true_type) {
+		for (; p && !p->stale(); p = p->parent()) p->set_stale(true);
+	}
+	static void settle(node *p) {
+		if (!stale_of(p)) return;
+		settle(p->left);
+		settle(p->right);
+		pull_summary(p, std::true_type());
+	}
+
+	static node *minimum(node *p) {
+		while (p->left) p = p->left;
+		return p;
+	}
+	static node *maximum(node *p) {
+		while (p->right) p = p->right;
+		return p;
+	}
+	static node *successor(node *p) {
+		if (p->right) return minimum(p->right);
+		node *q = p->parent();
+		while (q && p == q->right) {
+			p = q;
+			q = q->parent();
+		}
+		return q;
+	}
+	static node *predecessor(node *p) {
+		if (p->left) return maximum(p->left);
+		node *q = p->parent();
+		while (q && p == q->left) {
+			p = q;
+			q = q->parent();
+		}
+		return q;
+	}
+	/**
+	 * p, or the first live node after it; the last live node up to p.
+	 * the runs of tombstones they skip are bounded, see tombstone().
+	 */
+	static node *next_live(node *p) {
+		while (p && p->dead()) p = successor(p);
+		return p;
+	}
+	static node *prev_live(node *p) {
+		while (p && p->dead()) p = predecessor(p);
+		return p;
+	}
+	/**
+	 * the k-th (0-based) live node in the subtree of p, or null if there is none.
+	 */
+	static node *select(node *p, size_t k) {
+		while (p) {
+			size_t l = size_of(p->left);
+			if (k < l) {
+				p = p->left;
+			} else if (k == l && !p->dead()) {
+				return p;
+			} else {
+				k -= l + live(p);
+				p = p->right;
+			}
+		}
+		return nullptr;
+	}
+	/**
+	 * the number of live nodes before p in the whole tree.
+	 */
+	static size_t position(const node *p) {
+		size_t r = size_of(p->left);
+		for (const node *q = p->parent(); q; p = q, q = q->parent())
+			if (p == q->right) r += size_of(q->left) + live(q);
+		return r;
+	}
+
+	/**
+	 * a source of nodes for structural copy.
+	 * on assignment the nodes of the old tree are recycled
+	 *   before any new node is requested from operator new.
+	 */
+	class node_recycler {
+	private:
+		node *pool;
+	public:
+		explicit node_recycler(node *old_root) : pool(nullptr) {
+			// flatten the old tree into a list linked through `right'.
+			node *p = old_root;
+			while (p) {
+				if (p->left) {
+					node *l = p->left;
+					p->left = l->right;
+					l->right = p;
+					p = l;
+				} else {
+					node *r = p->right;
+					p->valptr()->~value_type();
+					p->right = pool;
+					pool = p;
+					p = r;
+				}
+			}
+		}
+		node *operator()(const value_type &value) {
+			if (!pool) return create_node(value);
+			node *p = pool;
+			pool = pool->right;
+			try {
+				new (p->storage) value_type(value);
+			} catch (...) {
+				deallocate_node(p);
+				throw;
+			}
+			p->fill(p->key());
+			return p;
+		}
+		~node_recycler() {
+			while (pool) {
+				node *p = pool;
+				pool = pool->right;
+				deallocate_node(p);
+			}
+		}
+	};
+
+	/**
+	 * clone the shape and colors of src below parent, without comparing keys.
+	 * recursion only follows left children; right spines are walked in a loop.
+	 */
+	template<class NodeGen>
+	static node *clone_tree(const node *src, node *parent, NodeGen &gen) {
+		node *top = gen(*src->valptr());
+		top->set_parent_red(parent, src->red());
+		top->set_dead(src->dead());
+		take_over(top, src);
+		top->left = top->right = nullptr;
+		try {
+			if (src->right) top->right = clone_tree(src->right, top, gen);
+			parent = top;
+			src = src->left;
+			while (src) {
+				node *p = gen(*src->valptr());
+				p->set_parent_red(parent, src->red());
+				p->set_dead(src->dead());
+				take_over(p, src);
+				p->left = p->right = nullptr;
+				parent->left = p;
+				if (src->right) p->right = clone_tree(src->right, p, gen);
+				parent = p;
+				src = src->left;
+			}
+		} catch (...) {
+			destroy_tree(top);
+			throw;
+		}
+		return top;
+	}
+
+	/**
+	 * the rebalancing primitives take the root by reference
+	 *   so that they also work on trees detached from the map.
+	 */
+	static void rotate_left(node *x, node *&root) {
+		node *y = x->right;
+		x->right = y->left;
+		if (y->left) y->left->set_parent(x);
+		y->set_parent(x->parent());
+		if (!x->parent()) root = y;
+		else if (x == x->parent()->left) x->parent()->left = y;
+		else x->parent()->right = y;
+		y->left = x;
+		x->set_parent(y);
+		take_over(y, x);
+		pull(x);
+	}
+	static void rotate_right(node *x, node *&root) {
+		node *y = x->left;
+		x->left = y->right;
+		if (y->right) y->right->set_parent(x);
+		y->set_parent(x->parent());
+		if (!x->parent()) root = y;
+		else if (x == x->parent()->right) x->parent()->right = y;
+		else x->parent()->left = y;
+		y->right = x;
+		x->set_parent(y);
+		take_over(y, x);
+		pull(x);
+	}
+	/**
+	 * resolve red-red conflicts above the red node x.
+	 * the root may be left red; the caller decides how to blacken it.
+	 */
+	static void insert_rebalance(node *x, node *&root) {
+		while (x != root && x->parent()->red()) {
+			node *p = x->parent(), *g = p->parent();
+			if (p == g->left) {
+				node *u = g->right;
+				if (u && u->red()) {
+					p->set_red(false);
+					u->set_red(false);
+					g->set_red(true);
+					x = g;
+				} else {
+					if (x == p->right) {
+						rotate_left(p, root);
+						x = p;
+						p = x->parent();
+					}
+					p->set_red(false);
+					g->set_red(true);
+					rotate_right(g, root);
+				}
+			} else {
+				node *u = g->left;
+				if (u && u->red()) {
+					p->set_red(false);
+					u->set_red(false);
+					g->set_red(true);
+					x = g;
+				} else {
+					if (x == p->left) {
+						rotate_right(p, root);
+						x = p;
+						p = x->parent();
+					}
+					p->set_red(false);
+					g->set_red(true);
+					rotate_left(g, root);
+				}
+			}
+		}
+	}
+	void insert_fixup(node *x) {
+		insert_rebalance(x, root);
+		root->set_red(false);
+	}
+	/**
+	 * restore the red-black properties after a black node was removed
+	 *   above x (x may be null, so its parent is passed explicitly).
+	 */
+	static void erase_rebalance(node *x, node *parent, node *&root) {
+		while (x != root && (!x || !x->red())) {
+			if (x == parent->left) {
+				node *w = parent->right;
+				if (w->red()) {
+					w->set_red(false);
+					parent->set_red(true);
+					rotate_left(parent, root);
+					w = parent->right;
+				}
+				if ((!w->left || !w->left->red()) && (!w->right || !w->right->red())) {
+					w->set_red(true);
+					x = parent;
+					parent = x->parent();
+				} else {
+					if (!w->right || !w->right->red()) {
+						w->left->set_red(false);
+						w->set_red(true);
+						rotate_right(w, root);
+						w = parent->right;
+					}
+					w->set_red(parent->red());
+					parent->set_red(false);
+					w->right->set_red(false);
+					rotate_left(parent, root);
+					x = root;
+				}
+			} else {
+				node *w = parent->left;
+				if (w->red()) {
+					w->set_red(false);
+					parent->set_red(true);
+					rotate_right(parent, root);
+					w = parent->left;
+				}
+				if ((!w->left || !w->left->red()) && (!w->right || !w->right->red())) {
+					w->set_red(true);
+					x = parent;
+					parent = x->parent();
+				} else {
+					if (!w->left || !w->left->red()) {
+						w->right->set_red(false);
+						w->set_red(true);
+						rotate_left(w, root);
+						w = parent->left;
+					}
+					w->set_red(parent->red());
+					parent->set_red(false);
+					w->left->set_red(false);
+					rotate_right(parent, root);
+					x = root;
+				}
+			}
+		}
+		if (x) x->set_red(false);
+	}
+	/**
+	 * put v in the place of u in u's parent.
+	 */
+	void transplant(node *u, node *v) {
+		if (!u->parent()) root = v;
+		else if (u == u->parent()->left) u->parent()->left = v;
+		else u->parent()->right = v;
+		if (v) v->set_parent(u->parent());
+	}
+	/**
+	 * take the live node z out of the tree without destroying it.
+	 */
+	void unlink_node(node *z) {
+		if (z == header.leftmost) header.leftmost = next_live(successor(z));
+		if (z == header.rightmost) header.rightmost = prev_live(predecessor(z));
+		node *x, *xparent;
+		bool removed_red = z->red();
+		// every subtree that loses a node is on the path above the spliced-out position:
+		//   below z it is the successor moving up into z's place, from z up it is z.
+		node *s = (z->left && z->right) ? minimum(z->right) : z;
+		size_t moved = live(s);
+		for (; s->parent(); s = s->parent()) {
+			if (s->parent() == z) moved = 1;
+			s->parent()->sz -= moved;
+		}
+		if (!z->left) {
+			x = z->right;
+			xparent = z->parent();
+			transplant(z, x);
+		} else if (!z->right) {
+			x = z->left;
+			xparent = z->parent();
+			transplant(z, x);
+		} else {
+			node *y = minimum(z->right);
+			removed_red = y->red();
+			x = y->right;
+			if (y->parent() == z) {
+				xparent = y;
+			} else {
+				xparent = y->parent();
+				transplant(y, x);
+				y->right = z->right;
+				y->right->set_parent(y);
+			}
+			transplant(z, y);
+			y->left = z->left;
+			y->left->set_parent(y);
+			y->set_red(z->red());
+			y->sz = z->sz;
+		}
+		pull_path(xparent);
+		if (!removed_red) erase_rebalance(x, xparent, root);
+		--num;
+	}
+	void erase_node(node *z) {
+		unlink_node(z);
+		destroy_node(z);
+	}
+	/**
+	 * the node holding key, or null after setting where a node with key would be attached.
+	 * the node found may be a tombstone, which place_node() then reuses.
+	 */
+	node *insert_position(const Key &key, node *&parent, bool &goes_left) const {
+		key_probe probe = probe_of(key);
+		node *p = root;
+		parent = nullptr;
+		goes_left = true;
+		while (p) {
+			parent = p;
+			int o = probe.order(p);
+			if (o == 0) return p;
+			goes_left = o < 0;
+			p = goes_left ? p->left : p->right;
+		}
+		return nullptr;
+	}
+	/**
+	 * where a node with key would be attached after all nodes with an equal key,
+	 *   for the containers that allow duplicates.
+	 */
+	void insert_position_multi(const Key &key, node *&parent, bool &goes_left) const {
+		key_probe probe = probe_of(key);
+		node *p = root;
+		parent = nullptr;
+		goes_left = true;
+		while (p) {
+			parent = p;
+			goes_left = probe.before(p);
+			p = goes_left ? p->left : p->right;
+		}
+	}
+	/**
+	 * attach the detached node x at the position found by insert_position.
+	 */
+	void link_node(node *x, node *parent, bool goes_left) {
+		x->left = x->right = nullptr;
+		x->set_parent_red(parent, true);
+		pull(x);
+		if (!parent) root = x;
+		else if (goes_left) parent->left = x;
+		else parent->right = x;
+		if (dead) {
+			// the neighbours of x in the tree may be tombstones.
+			note_live_end(x);
+		} else {
+			if (!parent || (parent == header.leftmost && goes_left)) header.leftmost = x;
+			if (!parent || (parent == header.rightmost && !goes_left)) header.rightmost = x;
+		}
+		for (node *p = parent; p; p = p->parent()) ++p->sz;
+		pull_path(parent);
+		insert_fixup(x);
+		++num;
+	}
+	void note_live_end(node *x) {
+		if (!header.leftmost || cmp(x->key(), header.leftmost->key())) header.leftmost = x;
+		if (!header.rightmost || cmp(header.rightmost->key(), x->key())) header.rightmost = x;
+	}
+	/**
+	 * lazy erase: leave p in the tree as a tombstone, which lookups and
+	 *   iteration skip, in O(log n) and without any rotation.
+	 * once the tombstones outnumber the live nodes the tree is compacted, so
+	 *   it is never more than twice as large (one level deeper) as without
+	 *   them, and the O(n) compaction is paid for by the erases before it.
+	 */
+	void tombstone(node *p) {
+		if (p == header.leftmost) header.leftmost = next_live(successor(p));
+		if (p == header.rightmost) header.rightmost = prev_live(predecessor(p));
+		p->set_dead(true);
+		for (node *q = p; q; q = q->parent()) --q->sz;
+		pull_path(p);
+		--num;
+		if (++dead > num) compact();
+	}
+	/**
+	 * put the detached node x in the place of the tombstone d with the same key,
+	 *   which is destroyed; the shape of the tree is not changed.
+	 */
+	void replace_tombstone(node *d, node *x) {
+		x->left = d->left;
+		x->right = d->right;
+		x->parent_red = d->parent_red & ~(uintptr_t)4;
+		x->sz = d->sz;
+		if (x->left) x->left->set_parent(x);
+		if (x->right) x->right->set_parent(x);
+		node *p = d->parent();
+		if (!p) root = x;
+		else if (p->left == d) p->left = x;
+		else p->right = x;
+		destroy_node(d);
+		note_live_end(x);
+		for (node *q = x; q; q = q->parent()) ++q->sz;
+		pull_path(x);
+		++num;
+		--dead;
+	}
+	/**
+	 * attach x, whose key insert_position was asked about: in the place of
+	 *   the tombstone it found, or where it said a new node would go.
+	 */
+	void place_node(node *x, node *found, node *parent, bool goes_left) {
+		if (found) replace_tombstone(found, x);
+		else link_node(x, parent, goes_left);
+	}
+	/**
+	 * drop every tombstone and relink the live nodes into a balanced tree in O(n)
+	 *   time and no extra memory; they stay where they are, and so do iterators to them.
+	 */
+	void compact() {
+		if (!dead) return;
+		// flatten the tree into a list of live nodes linked through `right', in order.
+		node *list = nullptr, **tail = &list, *p = root;
+		while (p) {
+			if (p->left) {
+				node *l = p->left;
+				p->left = l->right;
+				l->right = p;
+				p = l;
+			} else {
+				node *r = p->right;
+				if (p->dead()) {
+					destroy_node(p);
+				} else {
+					*tail = p;
+					tail = &p->right;
+				}
+				p = r;
+			}
+		}
+		*tail = nullptr;
+		int red_depth = 0;
+		while (((size_t)2 << red_depth) <= num + 1) ++red_depth;
+		root = build_from_list(list, num, 0, red_depth);
+		dead = 0;
+		reset_header();
+	}
+	/**
+	 * build_balanced for the first n nodes of a list linked through `right',
+	 *   which is advanced past them.
+	 */
+	static node *build_from_list(node *&list, size_t n, int level, int red_depth) {
+		if (!n) return nullptr;
+		size_t mid = n / 2;
+		node *l = build_from_list(list, mid, level + 1, red_depth), *m = list;
+		list = list->right;
+		m->set_parent_red(nullptr, level == red_depth);
+		m->left = l;
+		m->right = build_from_list(list, n - mid - 1, level + 1, red_depth);
+		if (m->left) m->left->set_parent(m);
+		if (m->right) m->right->set_parent(m);
+		pull(m);
+		return m;
+	}
+	/**
+	 * join-based tree surgery used by range erase.
+	 * a detached tree is described by its black root and its black height
+	 *   (the number of black nodes on a path from the root down to null).
+	 */
+	struct subtree {
+		node *root;
+		int bh;
+		subtree(node *root = nullptr, int bh = 0) : root(root), bh(bh) {}
+	};
+	/**
+	 * make the child c of a node with black height bh a tree of its own.
+	 */
+	static subtree detach(node *c, int bh) {
+		if (!c) return subtree();
+		c->set_parent(nullptr);
+		if (c->red()) {
+			c->set_red(false);
+			return subtree(c, bh + 1);
+		}
+		return subtree(c, bh);
+	}
+	/**
+	 * concatenate l, m and r, where every key in l < m's key < every key in r.
+	 * takes O(|l.bh - r.bh| + 1) time.
+	 */
+	static subtree join(subtree l, node *m, subtree r) {
+		m->left = m->right = nullptr;
+		if (l.bh == r.bh) {
+			m->left = l.root;
+			m->right = r.root;
+			if (l.root) l.root->set_parent(m);
+			if (r.root) r.root->set_parent(m);
+			m->set_parent_red(nullptr, false);
+			pull(m);
+			return subtree(m, l.bh + 1);
+		}
+		bool taller_left = l.bh > r.bh;
+		subtree &t = taller_left ? l : r, &s = taller_left ? r : l;
+		// walk the inner spine of the taller tree down to a black node as high as s.
+		node *c = t.root, *parent = nullptr;
+		int h = t.bh;
+		while (h > s.bh || (c && c->red())) {
+			if (!c->red()) --h;
+			parent = c;
+			c = taller_left ? c->right : c->left;
+		}
+		m->set_parent_red(parent, true);
+		if (taller_left) {
+			m->left = c;
+			m->right = s.root;
+			parent->right = m;
+		} else {
+			m->left = s.root;
+			m->right = c;
+			parent->left = m;
+		}
+		if (c) c->set_parent(m);
+		if (s.root) s.root->set_parent(m);
+		pull(m);
+		for (node *p = parent; p; p = p->parent()) p->sz += size_of(s.root) + 1;
+		pull_path(parent);
+		node *root = t.root;
+		insert_rebalance(m, root);
+		int bh = t.bh;
+		if (root->red()) {
+			root->set_red(false);
+			++bh;
+		}
+		return subtree(root, bh);
+	}
+	/**
+	 * split t around the node at position k (0-based, k < size of t):
+	 *   l receives the nodes before it, r the nodes after it,
+	 *   and the node itself is returned unlinked.
+	 */
+	static node *split(subtree t, size_t k, subtree &l, subtree &r) {
+		node *p = t.root;
+		int hc = t.bh - (p->red() ? 0 : 1);
+		subtree a = detach(p->left, hc), b = detach(p->right, hc);
+		size_t ls = size_of(a.root);
+		if (k < ls) {
+			subtree mid;
+			node *pivot = split(a, k, l, mid);
+			r = join(mid, p, b);
+			return pivot;
+		}
+		if (k == ls) {
+			l = a;
+			r = b;
+			return p;
+		}
+		subtree mid;
+		node *pivot = split(b, k - ls - 1, mid, r);
+		l = join(a, p, mid);
+		return pivot;
+	}
+	int black_height() const {
+		int h = 0;
+		for (const node *p = root; p; p = p->left)
+			if (!p->red()) ++h;
+		return h;
+	}
+	subtree whole() const { return subtree(root, black_height()); }
+	/**
+	 * split t around key: l receives the smaller keys, r the greater ones,
+	 *   and the node holding key (if any) is returned unlinked.
+	 * if the comparator throws, every node of t has been destroyed.
+	 */
+	node *split_key(subtree t, const Key &key, subtree &l, subtree &r) const {
+		if (!t.root) {
+			l = r = subtree();
+			return nullptr;
+		}
+		node *p = t.root;
+		bool before, after;
+		try {
+			before = cmp(key, p->key());
+			after = !before && cmp(p->key(), key);
+		} catch (...) {
+			destroy_tree(p);
+			throw;
+		}
+		int hc = t.bh - (p->red() ? 0 : 1);
+		subtree a = detach(p->left, hc), b = detach(p->right, hc);
+		subtree mid;
+		if (before || after) {
+			node *found;
+			try {
+				found = before ? split_key(a, key, l, mid) : split_key(b, key, mid, r);
+			} catch (...) {
+				destroy_tree(before ? b.root : a.root);
+				destroy_node(p);
+				throw;
+			}
+			if (before) r = join(mid, p, b);
+			else l = join(a, p, mid);
+			return found;
+		}
+		l = a;
+		r = b;
+		return p;
+	}
+	/**
+	 * concatenate l and r, where every key in l < every key in r.
+	 */
+	static subtree join2(subtree l, subtree r) {
+		if (!l.root) return r;
+		if (!r.root) return l;
+		subtree rest, none;
+		node *last = split(l, size_of(l.root) - 1, rest, none);
+		return join(rest, last, r);
+	}
+	/**
+	 * the bulk operations below split a tree at the root key of the other one
+	 *   and recurse on the two halves, which touch disjoint nodes and so
+	 *   can run on different threads (Blelloch, Ferizovic and Sun, 2016).
+	 * a branch is forked while depth > 0 and it holds parallel_grain nodes or more;
+	 *   depth is 0 unless parallel is set.
+	 */
+	static const size_t parallel_grain = 1 << 14;
+	int fork_depth() const {
+		if (!parallel) return 0;
+		unsigned threads = std::thread::hardware_concurrency();
+		int depth = 0;
+		while ((1u << depth) < threads) ++depth;
+		return depth;
+	}
+	/**
+	 * run f1 and f2, on two threads if fork is set, and wait for both
+	 *   even if one of them throws. the exception is returned rather than
+	 *   thrown (f1's if both threw), so the caller can free what the other
+	 *   one built first. if no thread can be started, f1 runs here.
+	 */
+	template<class F1, class F2>
+	static std::exception_ptr fork_join(bool fork, F1 f1, F2 f2) {
+		std::exception_ptr e1, e2;
+		auto run1 = [&] {
+			try {
+				f1();
+			} catch (...) {
+				e1 = std::current_exception();
+			}
+		};
+		std::future<void> left;
+		if (fork) {
+			try {
+				left = std::async(std::launch::async, run1);
+			} catch (...) {
+				fork = false;
+			}
+		}
+		if (!fork) run1();
+		try {
+			f2();
+		} catch (...) {
+			e2 = std::current_exception();
+		}
+		if (fork) left.get();
+		return e1 ? e1 : e2;
+	}
+	/**
+	 * the nodes of a and b are consumed; a keeps its element on equal keys.
+	 * if the comparator throws, every node of a and b has been destroyed
+	 *   by the time the exception leaves, whichever thread it was thrown on.
+	 */
+	subtree union_trees(subtree a, subtree b, int depth) const {
+		if (!a.root) return b;
+		if (!b.root) return a;
+		node *m = a.root, *dup;
+		bool fork = depth > 0 && size_of(a.root) + size_of(b.root) >= parallel_grain;
+		subtree b1, b2, l, r;
+		try {
+			dup = split_key(b, m->key(), b1, b2);
+		} catch (...) {
+			destroy_tree(m);
+			throw;
+		}
+		if (dup) destroy_node(dup);
+		int hc = a.bh - (m->red() ? 0 : 1);
+		subtree a1 = detach(m->left, hc), a2 = detach(m->right, hc);
+		std::exception_ptr e = fork_join(fork,
+			[&] { l = union_trees(a1, b1, depth - 1); },
+			[&] { r = union_trees(a2, b2, depth - 1); });
+		if (e) {
+			destroy_tree(l.root);
+			destroy_tree(r.root);
+			destroy_node(m);
+			std::rethrow_exception(e);
+		}
+		return join(l, m, r);
+	}
+	subtree intersect_trees(subtree a, subtree b, int depth) const {
+		if (!a.root || !b.root) {
+			destroy_tree(a.root);
+			destroy_tree(b.root);
+			return subtree();
+		}
+		node *m = a.root, *dup;
+		bool fork = depth > 0 && size_of(a.root) + size_of(b.root) >= parallel_grain;
+		subtree b1, b2, l, r;
+		try {
+			dup = split_key(b, m->key(), b1, b2);
+		} catch (...) {
+			destroy_tree(m);
+			throw;
+		}
+		int hc = a.bh - (m->red() ? 0 : 1);
+		subtree a1 = detach(m->left, hc), a2 = detach(m->right, hc);
+		std::exception_ptr e = fork_join(fork,
+			[&] { l = intersect_trees(a1, b1, depth - 1); },
+			[&] { r = intersect_trees(a2, b2, depth - 1); });
+		if (e) {
+			destroy_tree(l.root);
+			destroy_tree(r.root);
+			destroy_node(m);
+			if (dup) destroy_node(dup);
+			std::rethrow_exception(e);
+		}
+		if (dup) {
+			destroy_node(dup);
+			return join(l, m, r);
+		}
+		destroy_node(m);
+		return join2(l, r);
+	}
+	subtree difference_trees(subtree a, subtree b, int depth) const {
+		if (!a.root || !b.root) {
+			destroy_tree(b.root);
+			return a;
+		}
+		node *m = a.root, *dup;
+		bool fork = depth > 0 && size_of(a.root) + size_of(b.root) >= parallel_grain;
+		subtree b1, b2, l, r;
+		try {
+			dup = split_key(b, m->key(), b1, b2);
+		} catch (...) {
+			destroy_tree(m);
+			throw;
+		}
+		int hc = a.bh - (m->red() ? 0 : 1);
+		subtree a1 = detach(m->left, hc), a2 = detach(m->right, hc);
+		std::exception_ptr e = fork_join(fork,
+			[&] { l = difference_trees(a1, b1, depth - 1); },
+			[&] { r = difference_trees(a2, b2, depth - 1); });
+		if (e) {
+			destroy_tree(l.root);
+			destroy_tree(r.root);
+			destroy_node(m);
+			if (dup) destroy_node(dup);
+			std::rethrow_exception(e);
+		}
+		if (dup) {
+			destroy_node(dup);
+			destroy_node(m);
+			return join2(l, r);
+		}
+		return join(l, m, r);
+	}
+	/**
+	 * replace the contents by t, which was built from the old tree and other's.
+	 */
+	void adopt(subtree t, rb_tree &other) {
+		root = t.root;
+		num = size_of(root);
+		reset_header();
+		other.root = nullptr;
+		other.num = other.dead = 0;
+		other.reset_header();
+	}
+	/**
+	 * stable merge sort of nodes by key, with the halves sorted in parallel.
+	 * if the comparator throws, a[0, n) may have lost or repeated some nodes,
+	 *   so the caller must keep a list of its own to free them.
+	 */
+	void sort_nodes(node **a, size_t n, int depth) const {
+		const Compare &c = cmp;
+		auto less = [&c](const node *x, const node *y) { return c(x->key(), y->key()); };
+		if (depth <= 0 || n < parallel_grain) {
+			std::stable_sort(a, a + n, less);
+			return;
+		}
+		size_t mid = n / 2;
+		std::exception_ptr e = fork_join(true,
+			[&] { sort_nodes(a, mid, depth - 1); },
+			[&] { sort_nodes(a + mid, n - mid, depth - 1); });
+		if (e) std::rethrow_exception(e);
+		std::inplace_merge(a, a + mid, a + n, less);
+	}
+	/**
+	 * link the sorted nodes a[0, n) into a perfectly balanced tree.
+	 * every path from the root has floor(log2(n + 1)) or one more nodes,
+	 *   so coloring exactly the nodes at depth red_depth red makes it a red-black tree.
+	 */
+	static node *build_balanced(node **a, size_t n, node *parent, int level, int red_depth, int depth) {
+		if (!n) return nullptr;
+		size_t mid = n / 2;
+		node *m = a[mid];
+		m->set_parent_red(parent, level == red_depth);
+		fork_join(depth > 0 && n >= parallel_grain,
+			[&] { m->left = build_balanced(a, mid, m, level + 1, red_depth, depth - 1); },
+			[&] { m->right = build_balanced(a + mid + 1, n - mid - 1, m, level + 1, red_depth, depth - 1); });
+		pull(m);
+		return m;
+	}
+	/**
+	 * remove the nodes at positions [a, b) by splitting the tree around them
+	 *   and dropping the middle part as a whole.
+	 */
+	void erase_positions(size_t a, size_t b) {
+		if (a >= b) return;
+		if (a == 0 && b == num) {
+			clear_tree();
+			return;
+		}
+		subtree whole(root, black_height()), left, mid, right, rest;
+		if (b < num) {
+			node *last = split(whole, b, rest, right);
+			node *first = split(rest, a, left, mid);
+			destroy_tree(mid.root);
+			destroy_node(first);
+			root = join(left, last, right).root;
+			if (a == 0) header.leftmost = last;
+		} else {
+			node *first = split(whole, a, left, mid);
+			destroy_tree(mid.root);
+			destroy_node(first);
+			root = left.root;
+			header.rightmost = maximum(root);
+		}
+		num -= b - a;
+	}
+	size_t index_of(const node *p) const {
+		return p ? position(p) : num;
+	}
+	/**
+	 * the node n places after p in owner (null stands for end()).
+	 */
+	static node *advance(const rb_tree *owner, const node *p, long long n) {
+		if (!owner) throw invalid_iterator();
+		long long k = (long long)owner->index_of(p) + n;
+		if (k < 0 || k > (long long)owner->num) throw invalid_iterator();
+		return select(owner->root, (size_t)k);
+	}
+	/**
+	 * a key being looked up, as it is compared against the nodes on the way down:
+	 *   before(p) is key < p's key, after(p) is p's key < key, and order(p)
+	 *   folds both into a sign. the plain probe asks Compare for each.
+	 */
+	template<class K>
+	struct plain_probe {
+		const Compare &cmp;
+		const K &key;
+		plain_probe(const Compare &cmp, const K &key) : cmp(cmp), key(key) {}
+		bool before(const node *p) const { return cmp(key, p->key()); }
+		bool after(const node *p) const { return cmp(p->key(), key); }
+		int order(const node *p) const { return before(p) ? -1 : after(p) ? 1 : 0; }
+	};
+	/**
+	 * integral keys under std::less are copied into the probe and compared
+	 *   with the built-in operators, which become flag tests and conditional moves.
+	 */
+	struct value_probe {
+		Key key;
+		value_probe(const Compare &, const Key &key) : key(key) {}
+		bool before(const node *p) const { return key < p->key(); }
+		bool after(const node *p) const { return p->key() < key; }
+		int order(const node *p) const { return (int)(p->key() < key) - (int)(key < p->key()); }
+	};
+	/**
+	 * std::string keys under std::less compare the cached prefixes first,
+	 *   and otherwise make one three-way compare instead of two calls to less.
+	 */
+	struct prefix_probe {
+		const Key &key;
+		uint64_t prefix;
+		prefix_probe(const Compare &, const Key &key) : key(key), prefix(node::prefix_of(key)) {}
+		bool before(const node *p) const { return prefix != p->prefix ? prefix < p->prefix : key < p->key(); }
+		bool after(const node *p) const { return prefix != p->prefix ? p->prefix < prefix : p->key() < key; }
+		int order(const node *p) const {
+			if (prefix != p->prefix) return prefix < p->prefix ? -1 : 1;
+			int c = key.compare(p->key());
+			return c < 0 ? -1 : c > 0;
+		}
+	};
+	typedef typename std::conditional<
+		std::is_same<Key, std::string>::value && std::is_same<Compare, std::less<std::string> >::value,
+		prefix_probe,
+		typename std::conditional<
+			std::is_integral<Key>::value && std::is_same<Compare, std::less<Key> >::value,
+			value_probe,
+			plain_probe<Key>
+		>::type
+	>::type key_probe;
+	template<class K>
+	plain_probe<K> probe_of(const K &key) const { return plain_probe<K>(cmp, key); }
+	key_probe probe_of(const Key &key) const { return key_probe(cmp, key); }
+	/**
+	 * the lookup helpers accept any K that Compare can order against Key,
+	 *   so transparent probes reach the comparator without a temporary Key.
+	 */
+	template<class K>
+	node *lower_bound_node(const K &key) const {
+		auto probe = probe_of(key);
+		node *p = root, *r = nullptr;
+		while (p) {
+			if (probe.after(p)) {
+				p = p->right;
+			} else {
+				r = p;
+				p = p->left;
+			}
+		}
+		return next_live(r);
+	}
+	template<class K>
+	node *upper_bound_node(const K &key) const {
+		auto probe = probe_of(key);
+		node *p = root, *r = nullptr;
+		while (p) {
+			if (probe.before(p)) {
+				r = p;
+				p = p->left;
+			} else {
+				p = p->right;
+			}
+		}
+		return next_live(r);
+	}
+	template<class K>
+	size_t rank_of(const K &key) const {
+		auto probe = probe_of(key);
+		size_t r = 0;
+		for (const node *p = root; p; ) {
+			if (probe.after(p)) {
+				r += size_of(p->left) + live(p);
+				p = p->right;
+			} else {
+				p = p->left;
+			}
+		}
+		return r;
+	}
+	/**
+	 * the end of the equal range that starts at lo = lower_bound_node(key).
+	 */
+	template<class K>
+	node *range_end(node *lo, const K &key) const {
+		return (lo && !cmp(key, lo->key())) ? next_live(successor(lo)) : lo;
+	}
+	template<class K>
+	node *find_node(const K &key) const {
+		auto probe = probe_of(key);
+		node *p = root;
+		while (p) {
+			int o = probe.order(p);
+			if (o < 0) p = p->left;
+			else if (o > 0) p = p->right;
+			else return p->dead() ? nullptr : p;
+		}
+		return nullptr;
+	}
+	static void prefetch_node(const node *p) {
+#ifdef __GNUC__
+		__builtin_prefetch(p);
+		__builtin_prefetch(p->storage);
+#endif
+	}
+	/**
+	 * look up the keys in [first, last) in groups of batch_lanes searches,
+	 *   which descend in lockstep: each round moves every unfinished search
+	 *   down one level and prefetches the node it goes to, so the cache
+	 *   misses of one round overlap instead of being paid one after another.
+	 * report(node) is called for every key in order, with null for a miss.
+	 */
+	static const int batch_lanes = 16;
+	template<class KeyIt, class Report>
+	void find_nodes(KeyIt first, KeyIt last, Report &report) const {
+		const Key *keys[batch_lanes];
+		node *cur[batch_lanes], *hit[batch_lanes];
+		while (first != last) {
+			int n = 0;
+			for (; n < batch_lanes && first != last; ++n, ++first) {
+				keys[n] = &*first;
+				cur[n] = root;
+				hit[n] = nullptr;
+			}
+			for (bool active = root != nullptr; active; ) {
+				active = false;
+				for (int i = 0; i < n; ++i) {
+					node *p = cur[i];
+					if (!p) continue;
+					if (cmp(*keys[i], p->key())) {
+						p = p->left;
+					} else if (cmp(p->key(), *keys[i])) {
+						p = p->right;
+					} else {
+						hit[i] = p->dead() ? nullptr : p;
+						p = nullptr;
+					}
+					if (p) {
+						prefetch_node(p);
+						active = true;
+					}
+					cur[i] = p;
+				}
+			}
+			for (int i = 0; i < n; ++i) report(hit[i]);
+		}
+	}
+	struct batch_counter {
+		size_t hits;
+		void operator()(node *p) { if (p) ++hits; }
+	};
+	/**
+	 * a bidirectional iterator over the tree, for the containers that need
+	 *   nothing beyond ++, -- and dereference; a null node stands for end().
+	 * with Const the element is read-only. the mutable one converts to it.
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 *     like it = c.begin(); --it;
+	 *       or it = c.end(); ++end();
+	 */
+	template<bool Const>
+	class basic_iterator {
+		friend class rb_tree;
+		friend class basic_iterator<!Const>;
+	private:
+		typedef typename std::conditional<Const, const value_type, value_type>::type element;
+		const rb_tree *owner;
+		node *ptr;
+		basic_iterator(const rb_tree *owner, node *ptr) : owner(owner), ptr(ptr) {}
+	public:
+		basic_iterator() : owner(nullptr), ptr(nullptr) {}
+		basic_iterator(const basic_iterator &other) = default;
+		template<bool C, class = typename std::enable_if<Const && !C>::type>
+		basic_iterator(const basic_iterator<C> &other) : owner(other.owner), ptr(other.ptr) {}
+		basic_iterator & operator=(const basic_iterator &other) = default;
+		basic_iterator operator++(int) {
+			basic_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		basic_iterator & operator++() {
+			if (!owner || !ptr) throw invalid_iterator();
+			ptr = successor(ptr);
+			return *this;
+		}
+		basic_iterator operator--(int) {
+			basic_iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		basic_iterator & operator--() {
+			if (!owner || ptr == owner->header.leftmost) throw invalid_iterator();
+			ptr = ptr ? predecessor(ptr) : owner->header.rightmost;
+			return *this;
+		}
+		element & operator*() const {
+			if (!ptr) throw invalid_iterator();
+			if (!Const) touch(ptr);
+			return *ptr->valptr();
+		}
+		element * operator->() const noexcept {
+			if (!Const) touch(ptr);
+			return ptr->valptr();
+		}
+		template<bool C>
+		bool operator==(const basic_iterator<C> &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+		template<bool C>
+		bool operator!=(const basic_iterator<C> &rhs) const { return !(*this == rhs); }
+	};
+	basic_iterator<false> iterator_to(node *p) const { return basic_iterator<false>(this, p); }
+	basic_iterator<true> const_iterator_to(node *p) const { return basic_iterator<true>(this, p); }
+	/**
+	 * the node pos points at.
+	 * throw invalid_iterator if pos is end() or does not belong to this tree.
+	 */
+	template<bool Const>
+	node *node_at(const basic_iterator<Const> &pos) const {
+		if (pos.owner != this || !pos.ptr) throw invalid_iterator();
+		return pos.ptr;
+	}
+	/**
+	 * the number of nodes with a key equivalent to key, in O(log n).
+	 */
+	size_t count_equal(const Key &key) const {
+		return index_of(upper_bound_node(key)) - index_of(lower_bound_node(key));
+	}
+	/**
+	 * erase every node with a key equivalent to key, and return how many there were.
+	 */
+	size_t erase_equal(const Key &key) {
+		size_t lo = index_of(lower_bound_node(key)), hi = index_of(upper_bound_node(key));
+		erase_positions(lo, hi);
+		return hi - lo;
+	}
+	rb_tree() : root(nullptr), num(0), dead(0), lazy(false), parallel(false) {
+		reset_header();
+	}
+	/**
+	 * copies the tree shape node by node in O(n), no comparison is made.
+	 */
+	rb_tree(const rb_tree &other) : root(nullptr), num(0), dead(0), lazy(other.lazy), parallel(other.parallel), cmp(other.cmp) {
+		if (other.root) {
+			node *(*gen)(const value_type &) = create_node;
+			root = clone_tree(other.root, nullptr, gen);
+		}
+		num = other.num;
+		dead = other.dead;
+		reset_header();
+	}
+	/**
+	 * takes over the nodes of other, which is left empty.
+	 */
+	rb_tree(rb_tree &&other)
+		: root(other.root), num(other.num), dead(other.dead), lazy(other.lazy), parallel(other.parallel),
+		  cmp(std::move(other.cmp)), header(other.header) {
+		other.root = nullptr;
+		other.num = other.dead = 0;
+		other.reset_header();
+	}
+	/**
+	 * the nodes already owned by this tree are reused for the copy.
+	 */
+	rb_tree & operator=(const rb_tree &other) {
+		if (this == &other) return *this;
+		node_recycler gen(root);
+		root = nullptr;
+		num = dead = 0;
+		reset_header();
+		cmp = other.cmp;
+		lazy = other.lazy;
+		parallel = other.parallel;
+		if (other.root) root = clone_tree(other.root, nullptr, gen);
+		num = other.num;
+		dead = other.dead;
+		reset_header();
+		return *this;
+	}
+	rb_tree & operator=(rb_tree &&other) {
+		if (this == &other) return *this;
+		destroy_tree(root);
+		root = other.root;
+		num = other.num;
+		dead = other.dead;
+		lazy = other.lazy;
+		parallel = other.parallel;
+		cmp = std::move(other.cmp);
+		header = other.header;
+		other.root = nullptr;
+		other.num = other.dead = 0;
+		other.reset_header();
+		return *this;
+	}
+	~rb_tree() {
+		destroy_tree(root);
+	}
+	void clear_tree() {
+		destroy_tree(root);
+		root = nullptr;
+		num = dead = 0;
+		reset_header();
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * implement containers like std::set and std::multiset
+ */
+#ifndef SJTU_SET_HPP
+#define SJTU_SET_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "rb_tree.hpp"
+
+namespace sjtu {
+
+/**
+ * an ordered set of unique keys on the tree engine of sjtu::map.
+ * a node holds the key alone, with no mapped value next to it.
+ * the elements cannot be changed in place, so iterator and const_iterator
+ *   are the same read-only iterator.
+ */
+template<
+	class Key,
+	class Compare = std::less<Key>
+> class set : private rb_tree<Key, Key, key_of_key<Key>, Compare> {
+private:
+	typedef rb_tree<Key, Key, key_of_key<Key>, Compare> tree;
+	using typename tree::node;
+	using tree::num;
+	using tree::header;
+	using tree::create_node;
+	using tree::insert_position;
+	using tree::link_node;
+	using tree::erase_node;
+	using tree::find_node;
+	using tree::lower_bound_node;
+	using tree::upper_bound_node;
+	using tree::const_iterator_to;
+	using tree::node_at;
+	using tree::clear_tree;
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef typename tree::template basic_iterator<true> iterator;
+	typedef iterator const_iterator;
+
+	iterator begin() const { return const_iterator_to(header.leftmost); }
+	const_iterator cbegin() const { return begin(); }
+	iterator end() const { return const_iterator_to(nullptr); }
+	const_iterator cend() const { return end(); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	void clear() { clear_tree(); }
+	/**
+	 * insert key if it is not present yet.
+	 * return a pair of the iterator to key in the set, and whether it was inserted.
+	 */
+	pair<iterator, bool> insert(const Key &key) {
+		node *parent;
+		bool goes_left;
+		node *p = insert_position(key, parent, goes_left);
+		if (p) return pair<iterator, bool>(const_iterator_to(p), false);
+		p = create_node(key);
+		link_node(p, parent, goes_left);
+		return pair<iterator, bool>(const_iterator_to(p), true);
+	}
+	/**
+	 * throw invalid_iterator if pos is end() or belongs to another set.
+	 */
+	void erase(iterator pos) { erase_node(node_at(pos)); }
+	/**
+	 * returns the number of erased elements, 0 or 1.
+	 */
+	size_t erase(const Key &key) {
+		node *p = find_node(key);
+		if (!p) return 0;
+		erase_node(p);
+		return 1;
+	}
+	size_t count(const Key &key) const { return find_node(key) ? 1 : 0; }
+	iterator find(const Key &key) const { return const_iterator_to(find_node(key)); }
+	iterator lower_bound(const Key &key) const { return const_iterator_to(lower_bound_node(key)); }
+	iterator upper_bound(const Key &key) const { return const_iterator_to(upper_bound_node(key)); }
+};
+
+/**
+ * as set, but equal keys are kept, in the order they were inserted.
+ * count() and erase(key) take O(log n) (plus the erased nodes) thanks to
+ *   the subtree sizes, however many equal keys there are.
+ */
+template<
+	class Key,
+	class Compare = std::less<Key>
+> class multiset : private rb_tree<Key, Key, key_of_key<Key>, Compare> {
+private:
+	typedef rb_tree<Key, Key, key_of_key<Key>, Compare> tree;
+	using typename tree::node;
+	using tree::num;
+	using tree::header;
+	using tree::create_node;
+	using tree::insert_position_multi;
+	using tree::link_node;
+	using tree::erase_node;
+	using tree::lower_bound_node;
+	using tree::upper_bound_node;
+	using tree::cmp;
+	using tree::count_equal;
+	using tree::erase_equal;
+	using tree::const_iterator_to;
+	using tree::node_at;
+	using tree::clear_tree;
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef typename tree::template basic_iterator<true> iterator;
+	typedef iterator const_iterator;
+
+	iterator begin() const { return const_iterator_to(header.leftmost); }
+	const_iterator cbegin() const { return begin(); }
+	iterator end() const { return const_iterator_to(nullptr); }
+	const_iterator cend() const { return end(); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	void clear() { clear_tree(); }
+	/**
+	 * insert key after the elements equal to it; returns an iterator to it.
+	 */
+	iterator insert(const Key &key) {
+		node *parent;
+		bool goes_left;
+		insert_position_multi(key, parent, goes_left);
+		node *p = create_node(key);
+		link_node(p, parent, goes_left);
+		return const_iterator_to(p);
+	}
+	/**
+	 * throw invalid_iterator if pos is end() or belongs to another multiset.
+	 */
+	void erase(iterator pos) { erase_node(node_at(pos)); }
+	/**
+	 * erase every element equal to key; returns how many there were.
+	 */
+	size_t erase(const Key &key) { return erase_equal(key); }
+	size_t count(const Key &key) const { return count_equal(key); }
+	/**
+	 * the first element equal to key, or end().
+	 */
+	iterator find(const Key &key) const {
+		node *p = lower_bound_node(key);
+		return const_iterator_to(p && !cmp(key, p->key()) ? p : nullptr);
+	}
+	iterator lower_bound(const Key &key) const { return const_iterator_to(lower_bound_node(key)); }
+	iterator upper_bound(const Key &key) const { return const_iterator_to(upper_bound_node(key)); }
+	pair<iterator, iterator> equal_range(const Key &key) const {
+		return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,378 @@
+/**
+ * a variant of sjtu::map backed by a skip list, for append-heavy workloads
+ */
+#ifndef SJTU_SKIPLIST_MAP_HPP
+#define SJTU_SKIPLIST_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a skip list (Pugh) with the interface and iterator rules of sjtu::map.
+ *
+ * a node and its tower of next pointers are one allocation, with the level-i
+ *   link stored right after the node at next()[i], so a search reads the
+ *   links of a node from the cache line its key is on. towers of erased
+ *   nodes are kept on one free list per height and reused by later inserts.
+ * level 0 is also linked backwards, so iterators walk both ways in O(1).
+ *
+ * the last node of every level is remembered as well: inserting a key
+ *   greater than all others takes no search at all, and iterating a range
+ *   never rebalances or chases parent links.
+ *
+ * heights are drawn with probability 1/4 per extra level, as in
+ *   concurrent_map.
+ */
+template<
+	class Key,
+	class T,
+	class Compare = std::less<Key>
+> class skiplist_map {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	static const int max_level = 20;
+	/**
+	 * prev is null for the first element; the head sentinel carries no value.
+	 */
+	struct node {
+		node *prev;
+		int top;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+		value_type *valptr() { return reinterpret_cast<value_type *>(storage); }
+		const Key &key() { return valptr()->first; }
+		node **next() { return reinterpret_cast<node **>(this + 1); }
+	};
+
+	node *head;
+	// tails[i] is the last node of level i, or head if the level is empty.
+	node *tails[max_level];
+	// the free towers of every height, linked through next()[0].
+	node *pool[max_level];
+	// the number of levels in use.
+	int level;
+	size_t num;
+	Compare cmp;
+	uint64_t seed;
+
+	node *allocate_node(int top) {
+		node *p = pool[top];
+		if (p) pool[top] = p->next()[0];
+		else p = static_cast<node *>(::operator new(sizeof(node) + (top + 1) * sizeof(node *)));
+		p->top = top;
+		return p;
+	}
+	void release_node(node *p) {
+		p->next()[0] = pool[p->top];
+		pool[p->top] = p;
+	}
+	template<class... Args>
+	node *create_node(int top, Args &&... args) {
+		node *p = allocate_node(top);
+		try {
+			new (p->storage) value_type(std::forward<Args>(args)...);
+		} catch (...) {
+			release_node(p);
+			throw;
+		}
+		return p;
+	}
+	int random_level() {
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		int top = 0;
+		for (uint64_t bits = seed; top < max_level - 1 && (bits & 3) == 0; bits >>= 2) ++top;
+		return top;
+	}
+	void reset() {
+		for (int i = 0; i < max_level; ++i) head->next()[i] = nullptr, tails[i] = head;
+		level = 1;
+		num = 0;
+	}
+	void destroy_nodes() {
+		for (node *p = head->next()[0]; p; ) {
+			node *q = p->next()[0];
+			p->valptr()->~value_type();
+			::operator delete(p);
+			p = q;
+		}
+	}
+	node *first() const { return head->next()[0]; }
+	node *last() const { return tails[0] != head ? tails[0] : nullptr; }
+	/**
+	 * fill preds[i] with the last node on level i whose key is less than k.
+	 */
+	void find_preds(const Key &k, node **preds) const {
+		node *x = head;
+		for (int i = level - 1; i >= 0; --i) {
+			for (node *y = x->next()[i]; y && cmp(y->key(), k); y = x->next()[i]) x = y;
+			preds[i] = x;
+		}
+		for (int i = level; i < max_level; ++i) preds[i] = head;
+	}
+	node *lower_bound_node(const Key &k) const {
+		node *x = head;
+		for (int i = level - 1; i >= 0; --i)
+			for (node *y = x->next()[i]; y && cmp(y->key(), k); y = x->next()[i]) x = y;
+		return x->next()[0];
+	}
+	node *find_node(const Key &k) const {
+		node *p = lower_bound_node(k);
+		return p && !cmp(k, p->key()) ? p : nullptr;
+	}
+	/**
+	 * insert a node built from args unless k is present.
+	 * returns the node with k, and whether it is new.
+	 */
+	template<class... Args>
+	pair<node *, bool> insert_node(const Key &k, Args &&... args) {
+		node *preds[max_level];
+		node *tail = last();
+		if (tail && cmp(tail->key(), k)) {
+			for (int i = 0; i < max_level; ++i) preds[i] = tails[i];
+		} else {
+			find_preds(k, preds);
+			node *p = preds[0]->next()[0];
+			if (p && !cmp(k, p->key())) return pair<node *, bool>(p, false);
+		}
+		int top = random_level();
+		node *p = create_node(top, std::forward<Args>(args)...);
+		for (int i = 0; i <= top; ++i) {
+			p->next()[i] = preds[i]->next()[i];
+			preds[i]->next()[i] = p;
+			if (!p->next()[i]) tails[i] = p;
+		}
+		p->prev = preds[0] != head ? preds[0] : nullptr;
+		if (p->next()[0]) p->next()[0]->prev = p;
+		if (top >= level) level = top + 1;
+		++num;
+		return pair<node *, bool>(p, true);
+	}
+	void erase_node(node *p) {
+		node *preds[max_level];
+		find_preds(p->key(), preds);
+		for (int i = 0; i <= p->top; ++i) {
+			preds[i]->next()[i] = p->next()[i];
+			if (tails[i] == p) tails[i] = preds[i];
+		}
+		if (p->next()[0]) p->next()[0]->prev = p->prev;
+		while (level > 1 && !head->next()[level - 1]) --level;
+		p->valptr()->~value_type();
+		release_node(p);
+		--num;
+	}
+public:
+	/**
+	 * a bidirectional iterator; a null node stands for end().
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 *     like it = map.begin(); --it;
+	 *       or it = map.end(); ++end();
+	 */
+	class const_iterator;
+	class iterator {
+		friend class skiplist_map;
+		friend class const_iterator;
+	private:
+		skiplist_map *owner;
+		node *ptr;
+		iterator(skiplist_map *owner, node *ptr) : owner(owner), ptr(ptr) {}
+	public:
+		iterator() : owner(nullptr), ptr(nullptr) {}
+		iterator(const iterator &other) : owner(other.owner), ptr(other.ptr) {}
+		iterator & operator=(const iterator &other) = default;
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		iterator & operator++() {
+			if (!owner || !ptr) throw invalid_iterator();
+			ptr = ptr->next()[0];
+			return *this;
+		}
+		iterator operator--(int) {
+			iterator tmp = *this;
+			--*this;
+			return tmp;
+		}
+		iterator & operator--() {
+			if (!owner || ptr == owner->first()) throw invalid_iterator();
+			ptr = ptr ? ptr->prev : owner->last();
+			return *this;
+		}
+		value_type & operator*() const {
+			if (!owner || !ptr) throw invalid_iterator();
+			return *ptr->valptr();
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+		value_type* operator->() const noexcept { return ptr->valptr(); }
+	};
+	class const_iterator {
+		friend class skiplist_map;
+		friend class iterator;
+		private:
+			const skiplist_map *owner;
+			node *ptr;
+			const_iterator(const skiplist_map *owner, node *ptr) : owner(owner), ptr(ptr) {}
+		public:
+			const_iterator() : owner(nullptr), ptr(nullptr) {}
+			const_iterator(const const_iterator &other) : owner(other.owner), ptr(other.ptr) {}
+			const_iterator(const iterator &other) : owner(other.owner), ptr(other.ptr) {}
+			const_iterator & operator=(const const_iterator &other) = default;
+			const_iterator operator++(int) {
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (!owner || !ptr) throw invalid_iterator();
+				ptr = ptr->next()[0];
+				return *this;
+			}
+			const_iterator operator--(int) {
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+			const_iterator & operator--() {
+				if (!owner || ptr == owner->first()) throw invalid_iterator();
+				ptr = ptr ? ptr->prev : owner->last();
+				return *this;
+			}
+			const value_type & operator*() const {
+				if (!owner || !ptr) throw invalid_iterator();
+				return *ptr->valptr();
+			}
+			bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+			bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+			const value_type* operator->() const noexcept { return ptr->valptr(); }
+	};
+
+	skiplist_map() : seed(0x9e3779b97f4a7c15ULL) {
+		head = static_cast<node *>(::operator new(sizeof(node) + max_level * sizeof(node *)));
+		head->prev = nullptr;
+		head->top = max_level - 1;
+		for (int i = 0; i < max_level; ++i) pool[i] = nullptr;
+		reset();
+	}
+	/**
+	 * the elements of other arrive in order, so every one is appended
+	 *   to the tails without a search.
+	 * the target constructor has finished, so if a copy throws,
+	 *   the destructor releases what was built so far.
+	 */
+	skiplist_map(const skiplist_map &other) : skiplist_map() {
+		cmp = other.cmp;
+		for (node *p = other.first(); p; p = p->next()[0]) insert_node(p->key(), *p->valptr());
+	}
+	skiplist_map & operator=(const skiplist_map &other) {
+		if (this == &other) return *this;
+		skiplist_map tmp(other);
+		std::swap(head, tmp.head);
+		for (int i = 0; i < max_level; ++i) {
+			std::swap(tails[i], tmp.tails[i]);
+			std::swap(pool[i], tmp.pool[i]);
+		}
+		std::swap(level, tmp.level);
+		std::swap(num, tmp.num);
+		std::swap(cmp, tmp.cmp);
+		std::swap(seed, tmp.seed);
+		return *this;
+	}
+	~skiplist_map() {
+		destroy_nodes();
+		for (int i = 0; i < max_level; ++i)
+			for (node *p = pool[i]; p; ) {
+				node *q = p->next()[0];
+				::operator delete(p);
+				p = q;
+			}
+		::operator delete(head);
+	}
+	/**
+	 * access specified element with bounds checking.
+	 * throw index_out_of_bound if such key does not exist.
+	 */
+	T & at(const Key &key) {
+		node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		return p->valptr()->second;
+	}
+	const T & at(const Key &key) const {
+		node *p = find_node(key);
+		if (!p) throw index_out_of_bound();
+		return p->valptr()->second;
+	}
+	/**
+	 * access specified element, performing an insertion if such key does not already exist.
+	 */
+	T & operator[](const Key &key) {
+		return insert_node(key, key, T()).first->valptr()->second;
+	}
+	/**
+	 * behave like at() throw index_out_of_bound if such key does not exist.
+	 */
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	iterator begin() { return iterator(this, first()); }
+	const_iterator cbegin() const { return const_iterator(this, first()); }
+	iterator end() { return iterator(this, nullptr); }
+	const_iterator cend() const { return const_iterator(this, nullptr); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	/**
+	 * clears the contents; the head and the free towers are kept.
+	 */
+	void clear() {
+		destroy_nodes();
+		reset();
+	}
+	/**
+	 * insert an element.
+	 * return a pair, the first of the pair is
+	 *   the iterator to the new element (or the element that prevented the insertion),
+	 *   the second one is true if insert successfully, or false.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		pair<node *, bool> r = insert_node(value.first, value);
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
+	/**
+	 * erase the element at pos.
+	 *
+	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 */
+	void erase(iterator pos) {
+		if (pos.owner != this || !pos.ptr) throw invalid_iterator();
+		erase_node(pos.ptr);
+	}
+	size_t count(const Key &key) const { return find_node(key) ? 1 : 0; }
+	iterator find(const Key &key) { return iterator(this, find_node(key)); }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_node(key)); }
+	/**
+	 * returns an iterator to the first element whose key is not less than key,
+	 *   or end() if there is no such element.
+	 */
+	iterator lower_bound(const Key &key) { return iterator(this, lower_bound_node(key)); }
+	const_iterator lower_bound(const Key &key) const { return const_iterator(this, lower_bound_node(key)); }
+};
+
+}
+
+#endif
@@ -0,0 +1,429 @@
+/**
+ * implement a container like std::unordered_map
+ */
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+
+// only for std::hash<T> and std::equal_to<T>
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an open-addressing hash table with Robin Hood linear probing.
+ *
+ * every slot has a 32-bit info word: the low 8 bits hold the probe distance
+ *   plus one (0 marks an empty slot), the high 24 bits a fragment of the hash.
+ *   a lookup scans the info array, which packs 16 slots into a cache line,
+ *   and only follows a slot's node pointer when the fragment matches.
+ *   distances of 254 and more saturate at 255, and are then recomputed from
+ *   the full hash kept in the node, so a poor hash costs time but never fails.
+ * slots keep each probe run sorted by home bucket: an insertion shifts the
+ *   rest of its run one slot to the right, and an erasure shifts it back,
+ *   so no tombstones are needed and a miss stops at the first slot whose
+ *   distance is shorter than its own.
+ *
+ * values live in separately allocated nodes, so growing or shifting moves
+ *   pointers only: value_type needs nothing more than a copy constructor,
+ *   and references to elements stay valid until they are erased.
+ *   iterators are invalidated by any insertion or erasure.
+ */
+template<
+	class Key,
+	class T,
+	class Hash = std::hash<Key>,
+	class KeyEqual = std::equal_to<Key>
+> class unordered_map {
+public:
+	typedef pair<const Key, T> value_type;
+private:
+	struct node {
+		size_t hash;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+		value_type *valptr() { return reinterpret_cast<value_type *>(storage); }
+		const Key &key() { return valptr()->first; }
+	};
+
+	static const unsigned dist_mask = 0xff;
+	static const size_t min_capacity = 8;
+
+	unsigned *info;
+	node **nodes;
+	size_t cap, num;
+	Hash hasher;
+	KeyEqual eq;
+
+	static node *create_node(const value_type &value, size_t hash) {
+		node *p = static_cast<node *>(::operator new(sizeof(node)));
+		try {
+			new (p->storage) value_type(value);
+		} catch (...) {
+			::operator delete(p);
+			throw;
+		}
+		p->hash = hash;
+		return p;
+	}
+	static void destroy_node(node *p) {
+		p->valptr()->~value_type();
+		::operator delete(p);
+	}
+	/**
+	 * std::hash is the identity for integers, which would pile runs of keys
+	 *   into neighbouring buckets, so the hash is scrambled (splitmix64) first.
+	 */
+	size_t hash_of(const Key &key) const {
+		unsigned long long h = hasher(key);
+		h ^= h >> 30;
+		h *= 0xbf58476d1ce4e5b9ULL;
+		h ^= h >> 27;
+		h *= 0x94d049bb133111ebULL;
+		h ^= h >> 31;
+		return (size_t)h;
+	}
+	static unsigned make_info(size_t hash, size_t dist) {
+		unsigned frag = (unsigned)(hash >> (sizeof(size_t) * 8 - 24)) << 8;
+		return frag | (dist + 1 < dist_mask ? (unsigned)(dist + 1) : dist_mask);
+	}
+	/**
+	 * the probe distance of the occupied slot s.
+	 */
+	static size_t dist_of(const unsigned *info, node *const *nodes, size_t mask, size_t s) {
+		unsigned d = info[s] & dist_mask;
+		return d < dist_mask ? d - 1 : (s - (nodes[s]->hash & mask)) & mask;
+	}
+	/**
+	 * whether slot s is empty or holds an element closer to its home than dist,
+	 *   want being the info word of the probe at that distance.
+	 */
+	bool richer(size_t s, unsigned want, size_t dist) const {
+		unsigned c = info[s] & dist_mask, w = want & dist_mask;
+		if (c != dist_mask || w != dist_mask) return c < w;
+		return dist_of(info, nodes, cap - 1, s) < dist;
+	}
+	/**
+	 * the slot of key, or cap if it is not present.
+	 */
+	size_t find_slot(const Key &key) const {
+		if (num == 0) return cap;
+		size_t hash = hash_of(key), mask = cap - 1, s = hash & mask;
+		for (size_t d = 0;; s = (s + 1) & mask, ++d) {
+			unsigned want = make_info(hash, d);
+			if (richer(s, want, d)) return cap;
+			if (info[s] == want && eq(nodes[s]->key(), key)) return s;
+		}
+	}
+	size_t next_slot(size_t s) const {
+		while (s < cap && !info[s]) ++s;
+		return s;
+	}
+	/**
+	 * put p into fresh arrays with the given mask.
+	 */
+	static void place(unsigned *info, node **nodes, size_t mask, node *p) {
+		for (size_t s = p->hash & mask, d = 0;; s = (s + 1) & mask, ++d) {
+			if (!info[s]) {
+				info[s] = make_info(p->hash, d);
+				nodes[s] = p;
+				return;
+			}
+			size_t rd = dist_of(info, nodes, mask, s);
+			if (rd < d) {
+				node *q = nodes[s];
+				info[s] = make_info(p->hash, d);
+				nodes[s] = p;
+				p = q;
+				d = rd;
+			}
+		}
+	}
+	/**
+	 * move every node into a table of newcap slots.
+	 * only the allocation can throw, and then nothing has changed.
+	 */
+	void rehash(size_t newcap) {
+		unsigned *ninfo = static_cast<unsigned *>(::operator new(newcap * sizeof(unsigned)));
+		node **nnodes;
+		try {
+			nnodes = static_cast<node **>(::operator new(newcap * sizeof(node *)));
+		} catch (...) {
+			::operator delete(ninfo);
+			throw;
+		}
+		for (size_t i = 0; i < newcap; ++i) ninfo[i] = 0;
+		for (size_t s = 0; s < cap; ++s)
+			if (info[s]) place(ninfo, nnodes, newcap - 1, nodes[s]);
+		::operator delete(info);
+		::operator delete(nodes);
+		info = ninfo;
+		nodes = nnodes;
+		cap = newcap;
+	}
+	/**
+	 * the load factor is kept at most 7/8.
+	 */
+	void reserve_for(size_t n) {
+		size_t want = cap ? cap : min_capacity;
+		while (n > want / 8 * 7) want *= 2;
+		if (want != cap) rehash(want);
+	}
+	/**
+	 * returns the slot holding value's key, and whether it was inserted.
+	 */
+	pair<size_t, bool> insert_slot(const value_type &value) {
+		size_t hash = hash_of(value.first);
+		reserve_for(num + 1);
+		size_t mask = cap - 1, pos = hash & mask, d = 0;
+		for (;; pos = (pos + 1) & mask, ++d) {
+			unsigned want = make_info(hash, d);
+			if (richer(pos, want, d)) break;
+			if (info[pos] == want && eq(nodes[pos]->key(), value.first)) return pair<size_t, bool>(pos, false);
+		}
+		node *p = create_node(value, hash);
+		// every element from pos up to the next empty slot moves one step further.
+		size_t e = pos;
+		while (info[e]) e = (e + 1) & mask;
+		for (; e != pos; e = (e - 1) & mask) {
+			size_t prev = (e - 1) & mask;
+			info[e] = (info[prev] & dist_mask) == dist_mask ? info[prev] : info[prev] + 1;
+			nodes[e] = nodes[prev];
+		}
+		info[pos] = make_info(hash, d);
+		nodes[pos] = p;
+		++num;
+		return pair<size_t, bool>(pos, true);
+	}
+	void erase_slot(size_t s) {
+		destroy_node(nodes[s]);
+		size_t mask = cap - 1, next = (s + 1) & mask;
+		// backward shift: pull the rest of the run one step closer to home.
+		while ((info[next] & dist_mask) > 1) {
+			if ((info[next] & dist_mask) == dist_mask)
+				info[s] = make_info(nodes[next]->hash, dist_of(info, nodes, mask, next) - 1);
+			else
+				info[s] = info[next] - 1;
+			nodes[s] = nodes[next];
+			s = next;
+			next = (next + 1) & mask;
+		}
+		info[s] = 0;
+		--num;
+	}
+	void destroy_all() {
+		for (size_t s = 0; s < cap; ++s)
+			if (info[s]) destroy_node(nodes[s]);
+	}
+public:
+	/**
+	 * a forward iterator over the slots.
+	 *
+	 * if there is anything wrong throw invalid_iterator.
+	 *     like it = map.end(); ++it;
+	 */
+	class const_iterator;
+	class iterator {
+		friend class unordered_map;
+		friend class const_iterator;
+	private:
+		/**
+		 * the map this iterator belongs to, and the slot it points at.
+		 * past-the-end is the slot index cap.
+		 */
+		unordered_map *owner;
+		size_t slot;
+		iterator(unordered_map *owner, size_t slot) : owner(owner), slot(slot) {}
+	public:
+		iterator() : owner(nullptr), slot(0) {}
+		iterator(const iterator &other) : owner(other.owner), slot(other.slot) {}
+		iterator & operator=(const iterator &other) = default;
+		iterator operator++(int) {
+			iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		iterator & operator++() {
+			if (!owner || slot >= owner->cap) throw invalid_iterator();
+			slot = owner->next_slot(slot + 1);
+			return *this;
+		}
+		value_type & operator*() const {
+			if (!owner || slot >= owner->cap) throw invalid_iterator();
+			return *owner->nodes[slot]->valptr();
+		}
+		bool operator==(const iterator &rhs) const { return owner == rhs.owner && slot == rhs.slot; }
+		bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && slot == rhs.slot; }
+		bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+		bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+		value_type* operator->() const noexcept { return owner->nodes[slot]->valptr(); }
+	};
+	class const_iterator {
+		friend class unordered_map;
+		friend class iterator;
+		private:
+			const unordered_map *owner;
+			size_t slot;
+			const_iterator(const unordered_map *owner, size_t slot) : owner(owner), slot(slot) {}
+		public:
+			const_iterator() : owner(nullptr), slot(0) {}
+			const_iterator(const const_iterator &other) : owner(other.owner), slot(other.slot) {}
+			const_iterator(const iterator &other) : owner(other.owner), slot(other.slot) {}
+			const_iterator & operator=(const const_iterator &other) = default;
+			const_iterator operator++(int) {
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+			const_iterator & operator++() {
+				if (!owner || slot >= owner->cap) throw invalid_iterator();
+				slot = owner->next_slot(slot + 1);
+				return *this;
+			}
+			const value_type & operator*() const {
+				if (!owner || slot >= owner->cap) throw invalid_iterator();
+				return *owner->nodes[slot]->valptr();
+			}
+			bool operator==(const iterator &rhs) const { return owner == rhs.owner && slot == rhs.slot; }
+			bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && slot == rhs.slot; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+			const value_type* operator->() const noexcept { return owner->nodes[slot]->valptr(); }
+	};
+	unordered_map() : info(nullptr), nodes(nullptr), cap(0), num(0) {}
+	/**
+	 * the copy keeps the slot layout of other, so nothing is rehashed.
+	 */
+	unordered_map(const unordered_map &other)
+		: info(nullptr), nodes(nullptr), cap(0), num(0), hasher(other.hasher), eq(other.eq) {
+		if (!other.num) return;
+		info = static_cast<unsigned *>(::operator new(other.cap * sizeof(unsigned)));
+		try {
+			nodes = static_cast<node **>(::operator new(other.cap * sizeof(node *)));
+		} catch (...) {
+			::operator delete(info);
+			throw;
+		}
+		for (cap = 0; cap < other.cap; ++cap) info[cap] = 0;
+		try {
+			for (size_t s = 0; s < cap; ++s)
+				if (other.info[s]) {
+					nodes[s] = create_node(*other.nodes[s]->valptr(), other.nodes[s]->hash);
+					info[s] = other.info[s];
+				}
+		} catch (...) {
+			destroy_all();
+			::operator delete(info);
+			::operator delete(nodes);
+			throw;
+		}
+		num = other.num;
+	}
+	unordered_map & operator=(const unordered_map &other) {
+		if (this == &other) return *this;
+		unordered_map tmp(other);
+		std::swap(info, tmp.info);
+		std::swap(nodes, tmp.nodes);
+		std::swap(cap, tmp.cap);
+		std::swap(num, tmp.num);
+		std::swap(hasher, tmp.hasher);
+		std::swap(eq, tmp.eq);
+		return *this;
+	}
+	~unordered_map() {
+		destroy_all();
+		::operator delete(info);
+		::operator delete(nodes);
+	}
+	/**
+	 * access specified element with bounds checking
+	 * If no such element exists, an exception of type `index_out_of_bound'
+	 */
+	T & at(const Key &key) {
+		size_t s = find_slot(key);
+		if (s == cap) throw index_out_of_bound();
+		return nodes[s]->valptr()->second;
+	}
+	const T & at(const Key &key) const {
+		size_t s = find_slot(key);
+		if (s == cap) throw index_out_of_bound();
+		return nodes[s]->valptr()->second;
+	}
+	/**
+	 * access specified element, performing an insertion if such key does not already exist.
+	 */
+	T & operator[](const Key &key) {
+		size_t s = find_slot(key);
+		if (s != cap) return nodes[s]->valptr()->second;
+		s = insert_slot(value_type(key, T())).first;
+		return nodes[s]->valptr()->second;
+	}
+	/**
+	 * behave like at() throw index_out_of_bound if such key does not exist.
+	 */
+	const T & operator[](const Key &key) const {
+		return at(key);
+	}
+	iterator begin() { return iterator(this, next_slot(0)); }
+	const_iterator cbegin() const { return const_iterator(this, next_slot(0)); }
+	iterator end() { return iterator(this, cap); }
+	const_iterator cend() const { return const_iterator(this, cap); }
+	bool empty() const { return num == 0; }
+	size_t size() const { return num; }
+	/**
+	 * the number of slots; the table grows once size() exceeds 7/8 of it.
+	 */
+	size_t bucket_count() const { return cap; }
+	/**
+	 * make room for n elements without further rehashing.
+	 */
+	void reserve(size_t n) {
+		if (n) reserve_for(n);
+	}
+	/**
+	 * clears the contents; the slots are kept for reuse.
+	 */
+	void clear() {
+		destroy_all();
+		for (size_t s = 0; s < cap; ++s) info[s] = 0;
+		num = 0;
+	}
+	/**
+	 * insert an element.
+	 * return a pair, the first of the pair is
+	 *   the iterator to the new element (or the element that prevented the insertion),
+	 *   the second one is true if insert successfully, or false.
+	 */
+	pair<iterator, bool> insert(const value_type &value) {
+		pair<size_t, bool> r = insert_slot(value);
+		return pair<iterator, bool>(iterator(this, r.first), r.second);
+	}
+	/**
+	 * erase the element at pos.
+	 *
+	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 */
+	void erase(iterator pos) {
+		if (pos.owner != this || pos.slot >= cap || !info[pos.slot]) throw invalid_iterator();
+		erase_slot(pos.slot);
+	}
+	/**
+	 * Returns the number of elements with key
+	 *   that compares equivalent to the specified argument,
+	 *   which is either 1 or 0
+	 */
+	size_t count(const Key &key) const { return find_slot(key) != cap ? 1 : 0; }
+	/**
+	 * Finds an element with key equivalent to key.
+	 * If no such element is found, past-the-end (see end()) iterator is returned.
+	 */
+	iterator find(const Key &key) { return iterator(this, find_slot(key)); }
+	const_iterator find(const Key &key) const { return const_iterator(this, find_slot(key)); }
+};
+
+}
+
+#endif
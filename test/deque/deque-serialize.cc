@@ -0,0 +1,113 @@
+// Checks for sjtu::deque::serialize / deserialize and for_each_block against std::deque
+
+#include <iostream>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "deque.hpp"
+
+using namespace std;
+
+struct point{
+    int x;
+    double y;
+};
+
+bool check1(){ // round trip after pushes, pops, inserts and erases at both ends
+    for(int n = 0; n <= 20000; n += 4999){
+        sjtu::deque<int> Q;
+        std::deque<int> stdQ;
+        for(int i = 0; i < n; i++){
+            int t = rand();
+            if(rand() % 2){ Q.push_back(t); stdQ.push_back(t); }
+            else{ Q.push_front(t); stdQ.push_front(t); }
+        }
+        for(int i = 0; i < n / 4; i++){
+            int x = rand() % (int)stdQ.size();
+            Q.erase(Q.begin() + x); stdQ.erase(stdQ.begin() + x);
+            x = rand() % ((int)stdQ.size() + 1);
+            Q.insert(Q.begin() + x, i); stdQ.insert(stdQ.begin() + x, i);
+        }
+        stringstream ss;
+        Q.serialize(ss);
+        sjtu::deque<int> P;
+        P.push_back(-1);
+        P.deserialize(ss);
+        if(P.size() != stdQ.size()) return 0;
+        for(size_t i = 0; i < stdQ.size(); i++) if(P[i] != stdQ[i]) return 0;
+        P.push_front(7); P.push_back(8);
+        if(P.front() != 7 || P.back() != 8 || P.size() != stdQ.size() + 2) return 0;
+    }
+    return 1;
+}
+
+bool check2(){ // for_each_block covers the elements in order
+    sjtu::deque<point> Q;
+    std::deque<int> stdQ;
+    for(int i = 0; i < 30000; i++){
+        int t = rand();
+        if(rand() % 2){ Q.push_back(point{t, t * 0.5}); stdQ.push_back(t); }
+        else{ Q.push_front(point{t, t * 0.5}); stdQ.push_front(t); }
+    }
+    size_t seen = 0;
+    bool ok = true;
+    Q.for_each_block([&](const point *p, size_t len){
+        for(size_t i = 0; i < len; i++, seen++)
+            if(p[i].x != stdQ[seen] || p[i].y != stdQ[seen] * 0.5) ok = false;
+    });
+    if(!ok || seen != stdQ.size()) return 0;
+    stringstream ss;
+    Q.serialize(ss);
+    sjtu::deque<point> P;
+    P.deserialize(ss);
+    sjtu::deque<point>::const_iterator it = P.cbegin();
+    for(size_t i = 0; i < stdQ.size(); i++, it++) if(it -> x != stdQ[i]) return 0;
+    return it == P.cend();
+}
+
+bool check3(){ // rejected streams leave the deque unchanged
+    sjtu::deque<int> Q, P;
+    for(int i = 0; i < 1000; i++) Q.push_back(i);
+    P.push_back(42);
+    int res = 0;
+    stringstream ss;
+    Q.serialize(ss);
+    string image = ss.str();
+    stringstream truncated(image.substr(0, image.size() - 1));
+    try{ P.deserialize(truncated); } catch(...) { res++; }
+    stringstream garbage("not a deque image at all");
+    try{ P.deserialize(garbage); } catch(...) { res++; }
+    stringstream wide(image);
+    sjtu::deque<long long> L;
+    try{ L.deserialize(wide); } catch(...) { res++; }
+    return res == 3 && P.size() == 1 && P[0] == 42 && L.empty();
+}
+
+bool check4(){ // headers with absurd counts are rejected instead of hanging or overflowing
+    sjtu::deque<int> Q, P;
+    P.push_back(42);
+    stringstream ss;
+    Q.serialize(ss);
+    string image = ss.str();
+    unsigned long long counts[4] = {1ULL << 40, 1ULL << 62, (1ULL << 63) + 1, ~0ULL};
+    int res = 0;
+    for(int i = 0; i < 4; i++){
+        string bad = image;
+        memcpy(&bad[bad.size() - sizeof(counts[i])], &counts[i], sizeof(counts[i]));
+        stringstream corrupt(bad);
+        try{ P.deserialize(corrupt); } catch(...) { res++; }
+    }
+    return res == 4 && P.size() == 1 && P[0] == 42;
+}
+
+int main(){
+    srand(20171103);
+    if(check1()) puts("Test 1 Passed!!!!!!"); else puts("Test 1 Failed............");
+    if(check2()) puts("Test 2 Passed!!!!!!"); else puts("Test 2 Failed............");
+    if(check3()) puts("Test 3 Passed!!!!!!"); else puts("Test 3 Failed............");
+    if(check4()) puts("Test 4 Passed!!!!!!"); else puts("Test 4 Failed............");
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Checks for sjtu::compact_map against std::map
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "compact_map.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+bool check1(){ //operator[], insert, erase, find against std::map
+	sjtu::compact_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 200000; i++){
+		int a = rand() % 20000, b = rand();
+		switch(rand() % 4){
+			case 0: Q[a] = b; stdQ[a] = b; break;
+			case 1:
+				if(Q.insert(sjtu::compact_map<int, int>::value_type(a, b)).second != stdQ.insert(std::map<int, int>::value_type(a, b)).second) return 0;
+				break;
+			case 2:
+				if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); }
+				else if(Q.find(a) != Q.end()) return 0;
+				break;
+			default:
+				if(Q.count(a) != stdQ.count(a)) return 0;
+		}
+	}
+	if(Q.size() != stdQ.size()) return 0;
+	sjtu::compact_map<int, int>::const_iterator it = Q.cbegin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(it -> first != stdit -> first || (*it).second != stdit -> second) return 0;
+	}
+	if(it != Q.cend()) return 0;
+	for(std::map<int, int>::reverse_iterator stdit = stdQ.rbegin(); stdit != stdQ.rend(); stdit++){
+		if((--it) -> first != stdit -> first) return 0;
+	}
+	return it == Q.cbegin();
+}
+
+bool check2(){ //references survive growth of the arena, erased slots are reused
+	sjtu::compact_map<int, string> Q;
+	string &first = Q[-1];
+	first = "first";
+	for(int i = 0; i < 100000; i++) Q[i] = "x";
+	if(&Q.at(-1) != &first || Q.at(-1) != "first") return 0;
+	for(int i = 0; i < 100000; i += 2) Q.erase(Q.find(i));
+	for(int i = 0; i < 100000; i += 2) Q[i + 1000000] = "y";
+	if(Q.size() != 100001 || &Q.at(-1) != &first) return 0;
+	Q.clear();
+	if(!Q.empty() || Q.begin() != Q.end()) return 0;
+	Q[1] = "z";
+	return Q.size() == 1 && Q.begin() -> second == "z";
+}
+
+bool check3(){ //keys without assignment, copies and errors
+	{
+		sjtu::compact_map<Integer, string, Compare> Q;
+		for(int i = 0; i < 3000; i++) Q[Integer((i * 7) % 3001)] = "x";
+		for(int i = 0; i < 3000; i += 2) Q.erase(Q.find(Integer((i * 7) % 3001)));
+		sjtu::compact_map<Integer, string, Compare> P(Q), R;
+		R = P;
+		Q.clear();
+		if(P.size() != 1500 || R.size() != 1500 || !Q.empty()) return 0;
+		R[Integer(-5)] = "new";
+		if(R.begin() -> second != "new" || P.count(Integer(-5))) return 0;
+		int cnt = 0;
+		try{ R.at(Integer(-1)); } catch(...){ cnt++; }
+		try{ ++R.end(); } catch(...){ cnt++; }
+		try{ R.begin()--; } catch(...){ cnt++; }
+		try{ --Q.end(); } catch(...){ cnt++; }
+		try{ R.erase(P.begin()); } catch(...){ cnt++; }
+		try{ R.erase(R.end()); } catch(...){ cnt++; }
+		if(cnt != 6) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+
+	return 0;
+}
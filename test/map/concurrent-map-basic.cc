@@ -0,0 +1,134 @@
+// Checks for sjtu::concurrent_map under several threads
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include "concurrent_map.hpp"
+
+using namespace std;
+
+const int THREADS = 8;
+
+bool check1(){ //disjoint inserts and erases from every thread
+	sjtu::concurrent_map<int, int> Q;
+	atomic<int> failed(0);
+	vector<thread> workers;
+	for(int t = 0; t < THREADS; t++){
+		workers.push_back(thread([&Q, &failed, t](){
+			for(int i = t; i < 80000; i += THREADS){
+				if(!Q.insert(sjtu::concurrent_map<int, int>::value_type(i, i * 3))) failed++;
+			}
+			for(int i = t; i < 80000; i += THREADS){
+				if(i % 3 == 0 && !Q.erase(i)) failed++;
+			}
+		}));
+	}
+	for(int t = 0; t < THREADS; t++) workers[t].join();
+	if(failed) return 0;
+	if(Q.size() != 80000 - 26667) return 0;
+	for(int i = 0; i < 80000; i++){
+		int value = -1;
+		bool found = Q.find(i, value);
+		if(found != (i % 3 != 0) || Q.count(i) != (size_t)found) return 0;
+		if(found && value != i * 3) return 0;
+	}
+	return 1;
+}
+
+bool check2(){ //racing on the same keys: every key is won by exactly one thread
+	sjtu::concurrent_map<int, int> Q;
+	atomic<int> inserted(0), erased(0), arrived(0);
+	vector<thread> workers;
+	for(int t = 0; t < THREADS; t++){
+		workers.push_back(thread([&Q, &inserted, &erased, &arrived, t](){
+			for(int i = 0; i < 20000; i++){
+				if(Q.insert(sjtu::concurrent_map<int, int>::value_type(i, t))) inserted++;
+			}
+			arrived++;
+			while(arrived < THREADS) this_thread::yield();
+			for(int i = 0; i < 20000; i += 2){
+				if(Q.erase(i)) erased++;
+			}
+		}));
+	}
+	for(int t = 0; t < THREADS; t++) workers[t].join();
+	return inserted == 20000 && erased == 10000 && Q.size() == 10000;
+}
+
+bool check3(){ //readers see either nothing or a complete value while writers churn
+	sjtu::concurrent_map<int, string> Q;
+	atomic<int> failed(0);
+	vector<thread> workers;
+	for(int t = 0; t < THREADS; t++){
+		workers.push_back(thread([&Q, &failed, t](){
+			for(int i = 0; i < 30000; i++){
+				int key = (i * 7919 + t) % 2000;
+				if(t % 4 == 0){
+					if(i & 1) Q.insert(sjtu::concurrent_map<int, string>::value_type(key, to_string(key)));
+					else Q.erase(key);
+				}
+				else{
+					string value;
+					if(Q.find(key, value) && value != to_string(key)) failed++;
+				}
+			}
+		}));
+	}
+	for(int t = 0; t < THREADS; t++) workers[t].join();
+	int cnt = 0;
+	try{ Q.at(-1); } catch(...){ cnt++; }
+	return !failed && cnt == 1;
+}
+
+struct linked; //a value whose destructor erases another key of the same map
+sjtu::concurrent_map<int, linked> *chain_owner;
+atomic<int> linked_alive(0), chained_erases(0);
+struct linked {
+	int next;
+	linked(int next) : next(next) { linked_alive++; }
+	linked(const linked &rhs) : next(rhs.next) { linked_alive++; }
+	~linked() {
+		linked_alive--;
+		if(next >= 0 && chain_owner && chain_owner -> erase(next)) chained_erases++;
+	}
+};
+
+bool check4(){ //erased values are destroyed outside any lock, so their destructors may use the map
+	{
+		sjtu::concurrent_map<int, linked> Q;
+		vector<thread> workers;
+		for(int t = 0; t < THREADS; t++){
+			workers.push_back(thread([&Q, t](){
+				for(int i = t; i < 40000; i += THREADS){
+					Q.insert(sjtu::concurrent_map<int, linked>::value_type(i + 1000000, linked(-1)));
+					Q.insert(sjtu::concurrent_map<int, linked>::value_type(i, linked(i + 1000000)));
+				}
+			}));
+		}
+		for(int t = 0; t < THREADS; t++) workers[t].join();
+		workers.clear();
+		chain_owner = &Q; //from here on only the values the map frees run their destructors
+		for(int t = 0; t < THREADS; t++){
+			workers.push_back(thread([&Q, t](){
+				for(int i = t; i < 40000; i += THREADS) Q.erase(i);
+			}));
+		}
+		for(int t = 0; t < THREADS; t++) workers[t].join();
+		chain_owner = nullptr;
+		if(chained_erases == 0) return 0;
+		for(int i = 0; i < 40000; i++) if(Q.count(i)) return 0;
+	}
+	return linked_alive == 0;
+}
+
+int main(){
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+	if(!check4()) cout << "Test 4 Failed..." << endl; else cout << "Test 4 Passed!" << endl;
+
+	return 0;
+}
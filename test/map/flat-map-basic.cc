@@ -0,0 +1,144 @@
+// Checks for sjtu::flat_map against std::map
+
+#include <iostream>
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "flat_map.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+bool check1(){ //operator[], insert, erase, find against std::map
+	sjtu::flat_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 20000; i++){
+		int a = rand() % 10000, b = rand();
+		switch(rand() % 4){
+			case 0: Q[a] = b; stdQ[a] = b; break;
+			case 1:
+				if(Q.insert(sjtu::flat_map<int, int>::value_type(a, b)).second != stdQ.insert(std::map<int, int>::value_type(a, b)).second) return 0;
+				break;
+			case 2:
+				if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); }
+				else if(Q.find(a) != Q.end()) return 0;
+				break;
+			default:
+				if(Q.count(a) != stdQ.count(a)) return 0;
+		}
+	}
+	if(Q.size() != stdQ.size()) return 0;
+	sjtu::flat_map<int, int>::const_iterator it = Q.cbegin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(it -> first != stdit -> first || (*it).second != stdit -> second) return 0;
+	}
+	return it == Q.cend();
+}
+
+bool check2(){ //batched insert merges sorted runs, existing keys win
+	sjtu::flat_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int round = 0; round < 20; round++){
+		vector<sjtu::flat_map<int, int>::value_type> batch;
+		for(int i = 0; i < 1000; i++){
+			int a = rand() % 30000, b = rand();
+			batch.push_back(sjtu::flat_map<int, int>::value_type(a, b));
+			stdQ.insert(std::map<int, int>::value_type(a, b));
+		}
+		Q.insert(batch.begin(), batch.end());
+		if(Q.size() != stdQ.size()) return 0;
+	}
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++){
+		if(Q.at(stdit -> first) != stdit -> second) return 0;
+	}
+	return 1;
+}
+
+bool check3(){ //bounds, order statistics and range erase
+	sjtu::flat_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 5000; i++){
+		int a = rand() % 20000;
+		Q[a] = i; stdQ[a] = i;
+	}
+	for(int i = 0; i < 5000; i++){
+		int a = rand() % 20010 - 5;
+		std::map<int, int>::iterator lo = stdQ.lower_bound(a), hi = stdQ.upper_bound(a);
+		if((lo == stdQ.end() ? Q.end() : Q.find(lo -> first)) != Q.lower_bound(a)) return 0;
+		if((hi == stdQ.end() ? Q.end() : Q.find(hi -> first)) != Q.upper_bound(a)) return 0;
+		if(Q.lower_bound(a) - Q.begin() != (int)Q.rank(a)) return 0;
+	}
+	Q.erase(Q.lower_bound(5000), Q.lower_bound(15000));
+	stdQ.erase(stdQ.lower_bound(5000), stdQ.lower_bound(15000));
+	if(Q.size() != stdQ.size()) return 0;
+	size_t k = 0;
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, k++){
+		if(Q.nth(k) -> first != stdit -> first) return 0;
+	}
+	return 1;
+}
+
+bool check4(){ //keys without assignment or default constructor, copies, errors
+	{
+		sjtu::flat_map<Integer, string, Compare> Q;
+		for(int i = 0; i < 3000; i++) Q[Integer((i * 7) % 3001)] = "x";
+		for(int i = 0; i < 3000; i += 2) Q.erase(Q.find(Integer((i * 7) % 3001)));
+		sjtu::flat_map<Integer, string, Compare> P(Q), R;
+		R = P;
+		Q.clear();
+		if(P.size() != 1500 || R.size() != 1500 || !Q.empty()) return 0;
+		int cnt = 0;
+		try{ R.at(Integer(-1)); } catch(...){ cnt++; }
+		try{ ++R.end(); } catch(...){ cnt++; }
+		try{ R.begin()--; } catch(...){ cnt++; }
+		try{ R.erase(P.begin()); } catch(...){ cnt++; }
+		try{ R.erase(R.end()); } catch(...){ cnt++; }
+		if(cnt != 5) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+class Fragile {
+public:
+	static int counter, budget;
+	int val;
+	Fragile(int val) : val(val) { counter++; }
+	Fragile(const Fragile &rhs) : val(rhs.val) {
+		if (budget >= 0 && budget-- == 0) throw 0;
+		counter++;
+	}
+	Fragile & operator = (const Fragile &) = delete;
+	~Fragile() { counter--; }
+};
+int Fragile::counter = 0, Fragile::budget = -1;
+
+bool check5(){ //a copy throwing in the middle of an erase leaves the map unchanged
+	{
+		sjtu::flat_map<int, Fragile> Q;
+		for(int i = 0; i < 100; i++) Q.insert(sjtu::pair<const int, Fragile>(i, Fragile(i)));
+		int cnt = 0;
+		Fragile::budget = 30;
+		try{ Q.erase(Q.find(10)); } catch(...){ cnt++; }
+		Fragile::budget = 30;
+		try{ Q.erase(Q.begin() + 20, Q.begin() + 40); } catch(...){ cnt++; }
+		Fragile::budget = -1;
+		if(cnt != 2 || Q.size() != 100) return 0;
+		for(int i = 0; i < 100; i++) if(Q.at(i).val != i) return 0;
+		Q.erase(Q.begin() + 20, Q.begin() + 40);
+		if(Q.size() != 80 || Q.count(25) || Q.at(40).val != 40) return 0;
+	}
+	return Fragile::counter == 0;
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+	if(!check4()) cout << "Test 4 Failed..." << endl; else cout << "Test 4 Passed!" << endl;
+	if(!check5()) cout << "Test 5 Failed..." << endl; else cout << "Test 5 Passed!" << endl;
+
+	return 0;
+}
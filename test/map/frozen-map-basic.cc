@@ -0,0 +1,104 @@
+// Checks for sjtu::map::freeze, save / load_mmap and sjtu::frozen_map against std::map
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "map.hpp"
+#include "frozen_map.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+bool check1(){ //lookups of every size from 0 up, hits and misses
+	for(int n = 0; n <= 130; n++){
+		sjtu::map<int, int> Q;
+		for(int i = 0; i < n; i++) Q[2 * i] = i;
+		sjtu::frozen_map<int, int> F = Q.freeze();
+		if(F.size() != (size_t)n || F.empty() != (n == 0)) return 0;
+		for(int a = -1; a <= 2 * n; a++){
+			if(F.count(a) != Q.count(a)) return 0;
+			sjtu::frozen_map<int, int>::const_iterator it = F.lower_bound(a);
+			if(a >= 2 * n - 1){ if(it != F.end()) return 0; }
+			else if(it -> first != (a < 0 ? 0 : (a + 1) / 2 * 2)) return 0;
+			if(a >= 0 && a % 2 == 0 && a < 2 * n && (F.find(a) -> second != a / 2 || F.at(a) != a / 2)) return 0;
+		}
+	}
+	return 1;
+}
+
+bool check2(){ //iteration in both directions against std::map
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 30000; i++){
+		int a = rand() % 100000, b = rand();
+		Q[a] = b; stdQ[a] = b;
+	}
+	sjtu::frozen_map<int, int> F = Q.freeze();
+	Q.clear();
+	sjtu::frozen_map<int, int>::const_iterator it = F.cbegin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(it -> first != stdit -> first || (*it).second != stdit -> second) return 0;
+	}
+	if(it != F.cend()) return 0;
+	for(std::map<int, int>::reverse_iterator stdit = stdQ.rbegin(); stdit != stdQ.rend(); stdit++){
+		--it;
+		if(it -> first != stdit -> first) return 0;
+	}
+	return it == F.cbegin();
+}
+
+bool check3(){ //keys without assignment, copies and errors
+	{
+		sjtu::map<Integer, string, Compare> Q;
+		for(int i = 0; i < 3000; i++) Q[Integer((i * 7) % 3001)] = "x";
+		sjtu::frozen_map<Integer, string, Compare> F = Q.freeze(), G, H(F);
+		G = H;
+		if(G.size() != 3000 || G.at(Integer(7)) != "x") return 0;
+		int cnt = 0;
+		try{ G.at(Integer(-1)); } catch(...){ cnt++; }
+		try{ ++G.end(); } catch(...){ cnt++; }
+		try{ G.begin()--; } catch(...){ cnt++; }
+		try{ *G.find(Integer(3001)); } catch(...){ cnt++; }
+		if(cnt != 4) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+bool check4(){ //save and load_mmap round trip, and rejected files
+	const char *path = "/tmp/sjtu-frozen-map-check4.img";
+	for(int n = 0; n <= 3000; n += 1499){
+		sjtu::map<int, double> Q;
+		for(int i = 0; i < n; i++) Q[rand()] = i + 0.5;
+		Q.save(path);
+		sjtu::frozen_map<int, double> F = sjtu::map<int, double>::load_mmap(path), G;
+		if(F.size() != Q.size()) return 0;
+		sjtu::map<int, double>::const_iterator qit = Q.cbegin();
+		for(sjtu::frozen_map<int, double>::const_iterator it = F.cbegin(); it != F.cend(); it++, qit++){
+			if(it -> first != qit -> first || it -> second != qit -> second) return 0;
+			if(F.count(it -> first) != 1 || F.at(qit -> first) != qit -> second) return 0;
+		}
+		if(qit != Q.cend() || F.count(-1) != 0) return 0;
+		G = F; //an owning copy outlives the mapping
+		F = sjtu::frozen_map<int, double>();
+		if(G.size() != Q.size() || (n > 0 && G.at(Q.cbegin() -> first) != Q.cbegin() -> second)) return 0;
+	}
+	int cnt = 0;
+	try{ sjtu::frozen_map<int, int>::load_mmap(path); } catch(...){ cnt++; } //value size differs
+	try{ sjtu::frozen_map<int, double>::load_mmap("/tmp/sjtu-frozen-map-missing.img"); } catch(...){ cnt++; }
+	FILE *f = fopen(path, "wb"); fputs("not an image", f); fclose(f);
+	try{ sjtu::frozen_map<int, double>::load_mmap(path); } catch(...){ cnt++; }
+	remove(path);
+	return cnt == 3;
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+	if(!check4()) cout << "Test 4 Failed..." << endl; else cout << "Test 4 Passed!" << endl;
+
+	return 0;
+}
@@ -0,0 +1,756 @@
+// Extension checks: order statistics, iterator arithmetic, bounds, range erase,
+//   heterogeneous lookup, node extraction, move semantics,
+//   iterator error checks at both ends, batched lookups
+//   bulk set operations, range aggregates, lazy erase, the hot key cache
+//   single-descent find-or-insert and string keys compared by cached prefix,
+//   the cached ends through range erase and merge, set operations that throw,
+//   copy assignment that throws with the hot cache on,
+//   writes through a reference kept across aggregate()
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include "map.hpp"
+#include "set.hpp"
+
+using namespace std;
+
+bool check1(){ //nth & rank
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 30000; i++){
+		int a = rand() % 50000, b = rand();
+		Q[a] = b; stdQ[a] = b;
+		if(i % 3 == 0){
+			a = rand() % 50000;
+			if(stdQ.count(a)){
+				Q.erase(Q.find(a)); stdQ.erase(a);
+			}
+		}
+	}
+	if(Q.size() != stdQ.size()) return 0;
+	size_t k = 0;
+	for(std::map<int, int>::iterator it = stdQ.begin(); it != stdQ.end(); it++, k++){
+		if(Q.nth(k) -> first != it -> first) return 0;
+		if(Q.rank(it -> first) != k) return 0;
+	}
+	if(Q.nth(Q.size()) != Q.end()) return 0;
+	if(Q.rank(-1) != 0 || Q.rank(50000) != Q.size()) return 0;
+	return 1;
+}
+
+bool check2(){ //iterator + n, iterator - iterator
+	sjtu::map<int, int> Q;
+	for(int i = 1; i <= 10000; i++) Q[rand()] = i;
+	const sjtu::map<int, int> cQ(Q);
+	int n = (int)Q.size();
+	if(Q.end() - Q.begin() != n) return 0;
+	if(cQ.cend() - cQ.cbegin() != n) return 0;
+	sjtu::map<int, int>::iterator it = Q.begin();
+	for(int i = 0; i < n; i++, it++){
+		if(Q.begin() + i != it) return 0;
+		if(it - Q.begin() != i) return 0;
+		if(Q.end() - (n - i) != it) return 0;
+	}
+	sjtu::map<int, int>::const_iterator cit = cQ.cbegin();
+	cit += n / 2;
+	if(cit -> first != cQ.nth(n / 2) -> first) return 0;
+	cit -= n / 2;
+	if(cit != cQ.cbegin()) return 0;
+	return 1;
+}
+
+bool check3(){ //invalid iterator arithmetic
+	sjtu::map<int, int> Q, P;
+	for(int i = 1; i <= 100; i++) Q[i] = i;
+	int cnt = 0;
+	try{ Q.end() + 1; } catch(...){ cnt++; }
+	try{ Q.begin() - 1; } catch(...){ cnt++; }
+	try{ Q.begin() - P.begin(); } catch(...){ cnt++; }
+	try{ sjtu::map<int, int>::iterator it; it += 1; } catch(...){ cnt++; }
+	return cnt == 4;
+}
+
+bool check4(){ //lower_bound, upper_bound, equal_range
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 20000; i++){
+		int a = rand() % 100000;
+		Q[a] = i; stdQ[a] = i;
+	}
+	const sjtu::map<int, int> &cQ = Q;
+	for(int i = 1; i <= 20000; i++){
+		int a = rand() % 100010 - 5;
+		std::map<int, int>::iterator lo = stdQ.lower_bound(a), hi = stdQ.upper_bound(a);
+		sjtu::map<int, int>::iterator qlo = Q.lower_bound(a);
+		sjtu::map<int, int>::const_iterator qhi = cQ.upper_bound(a);
+		if((lo == stdQ.end()) != (qlo == Q.end())) return 0;
+		if(lo != stdQ.end() && lo -> first != qlo -> first) return 0;
+		if((hi == stdQ.end()) != (qhi == cQ.cend())) return 0;
+		if(hi != stdQ.end() && hi -> first != qhi -> first) return 0;
+		sjtu::pair<sjtu::map<int, int>::iterator, sjtu::map<int, int>::iterator> range = Q.equal_range(a);
+		if(range.first != qlo || range.second - range.first != (int)stdQ.count(a)) return 0;
+	}
+	return 1;
+}
+
+bool check5(){ //erase(first, last)
+	sjtu::map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int round = 1; round <= 200; round++){
+		for(int i = 1; i <= 500; i++){
+			int a = rand() % 100000;
+			Q[a] = i; stdQ[a] = i;
+		}
+		int a = rand() % 100000, b = rand() % 100000;
+		if(a > b) swap(a, b);
+		Q.erase(Q.lower_bound(a), Q.upper_bound(b));
+		stdQ.erase(stdQ.lower_bound(a), stdQ.upper_bound(b));
+		if(Q.size() != stdQ.size()) return 0;
+	}
+	Q.erase(Q.begin() + (int)Q.size() / 2, Q.end());
+	stdQ.erase(std::next(stdQ.begin(), stdQ.size() / 2), stdQ.end());
+	Q.erase(Q.begin(), Q.begin() + 10);
+	stdQ.erase(stdQ.begin(), std::next(stdQ.begin(), 10));
+	if(Q.size() != stdQ.size()) return 0;
+	sjtu::map<int, int>::iterator it = Q.begin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(stdit -> first != it -> first || stdit -> second != it -> second) return 0;
+	}
+	int cnt = 0;
+	try{ Q.erase(Q.end(), Q.begin()); } catch(...){ cnt++; }
+	sjtu::map<int, int> P;
+	try{ Q.erase(P.begin(), P.end()); } catch(...){ cnt++; }
+	Q.erase(Q.begin(), Q.end());
+	return cnt == 2 && Q.empty() && Q.begin() == Q.end();
+}
+
+class Name{
+public:
+	static int counter;
+	string s;
+	Name(const string &s) : s(s) { counter++; }
+	Name(const Name &other) : s(other.s) { counter++; }
+};
+int Name::counter = 0;
+
+struct NameLess{
+	typedef void is_transparent;
+	bool operator ()(const Name &a, const Name &b) const { return a.s < b.s; }
+	bool operator ()(const Name &a, const char *b) const { return strcmp(a.s.c_str(), b) < 0; }
+	bool operator ()(const char *a, const Name &b) const { return strcmp(a, b.s.c_str()) < 0; }
+};
+
+bool check6(){ //transparent comparator lookup
+	sjtu::map<Name, int, NameLess> Q;
+	char buf[20];
+	for(int i = 0; i < 1000; i++){
+		sprintf(buf, "k%d", i * 2);
+		Q.insert(sjtu::map<Name, int, NameLess>::value_type(Name(buf), i));
+	}
+	const sjtu::map<Name, int, NameLess> &cQ = Q;
+	int before = Name::counter;
+	for(int i = 0; i < 2000; i++){
+		sprintf(buf, "k%d", i);
+		const char *probe = buf;
+		if(Q.count(probe) != (size_t)(i % 2 == 0)) return 0;
+		if(i % 2 == 0){
+			if(Q.find(probe) -> second != i / 2) return 0;
+			if(cQ.at(probe) != i / 2) return 0;
+			if(Q.equal_range(probe).first != Q.find(probe)) return 0;
+		}
+		else{
+			if(Q.find(probe) != Q.end() || cQ.find(probe) != cQ.cend()) return 0;
+			try{ Q.at(probe); return 0; } catch(...){}
+		}
+		if(Q.lower_bound(probe) - Q.begin() != (int)Q.rank(probe)) return 0;
+		if(cQ.upper_bound(probe) != cQ.cbegin() + (int)(Q.rank(probe) + Q.count(probe))) return 0;
+	}
+	return Name::counter == before;
+}
+
+class Payload {
+public:
+	static int copies, alive;
+	int val;
+	Payload(int val = 0) : val(val) { alive++; }
+	Payload(const Payload &rhs) : val(rhs.val) { copies++; alive++; }
+	Payload & operator = (const Payload &rhs) { val = rhs.val; return *this; }
+	~Payload() { alive--; }
+};
+int Payload::copies = 0, Payload::alive = 0;
+
+bool check7(){ //extract, insert(node_type &&) and merge move elements without copies
+	{
+		sjtu::map<int, Payload> P, Q;
+		for(int i = 0; i < 2000; i++){ P[i * 2] = Payload(i); Q[i * 3] = Payload(-i); }
+		int copies = Payload::copies;
+		const Payload *addr = &P.at(10);
+		sjtu::map<int, Payload>::node_type nh = P.extract(P.find(10));
+		if(nh.empty() || nh.key() != 10 || &nh.mapped() != addr || P.count(10)) return 0;
+		if(!P.extract(10).empty() || P.size() != 1999) return 0;
+		nh.mapped().val = 100;
+		sjtu::map<int, Payload>::insert_return_type r = Q.insert(std::move(nh));
+		if(!r.inserted || !nh.empty() || &r.position -> second != addr || Q.at(10).val != 100) return 0;
+		r = Q.insert(Q.extract(12));
+		if(!r.inserted || r.position != Q.find(12)) return 0;
+		nh = P.extract(P.find(12));
+		r = Q.insert(std::move(nh));
+		if(r.inserted || r.node.empty() || r.node.mapped().val != 6 || Q.at(12).val != -4) return 0;
+		if(Q.insert(sjtu::map<int, Payload>::node_type()).position != Q.end()) return 0;
+
+		std::map<int, int> expect;
+		for(sjtu::map<int, Payload>::iterator it = Q.begin(); it != Q.end(); ++it) expect[it -> first] = it -> second.val;
+		for(sjtu::map<int, Payload>::iterator it = P.begin(); it != P.end(); ++it) expect.insert(std::make_pair(it -> first, it -> second.val));
+		size_t total = expect.size();
+		addr = &P.at(4);
+		Q.merge(P);
+		if(Q.size() != total || P.size() + Q.size() != 1998 + 2001 || &Q.at(4) != addr) return 0;
+		for(sjtu::map<int, Payload>::iterator it = P.begin(); it != P.end(); ++it) if(!Q.count(it -> first)) return 0;
+		size_t k = 0;
+		for(std::map<int, int>::iterator it = expect.begin(); it != expect.end(); ++it, ++k){
+			if(Q.nth(k) -> first != it -> first || Q.nth(k) -> second.val != it -> second) return 0;
+		}
+		if(Payload::copies != copies) return 0;
+		int cnt = 0;
+		try{ Q.extract(Q.end()); } catch(...){ cnt++; }
+		try{ Q.extract(P.begin()); } catch(...){ cnt++; }
+		try{ sjtu::map<int, Payload>::node_type().key(); } catch(...){ cnt++; }
+		if(cnt != 3) return 0;
+	}
+	return Payload::alive == 0;
+}
+
+class Heavy {
+public:
+	static int copies, moves;
+	int val;
+	Heavy(int val = 0) : val(val) {}
+	Heavy(const Heavy &rhs) : val(rhs.val) { copies++; }
+	Heavy(Heavy &&rhs) : val(rhs.val) { rhs.val = -1; moves++; }
+	Heavy & operator = (const Heavy &rhs) { val = rhs.val; copies++; return *this; }
+	Heavy & operator = (Heavy &&rhs) { val = rhs.val; rhs.val = -1; moves++; return *this; }
+};
+int Heavy::copies = 0, Heavy::moves = 0;
+
+struct HeavyLess {
+	bool operator () (const Heavy &lhs, const Heavy &rhs) const { return lhs.val < rhs.val; }
+};
+
+bool check8(){ //rvalue insert, operator[] with an rvalue key, map move construction and assignment
+	sjtu::map<Heavy, Heavy, HeavyLess> Q;
+	for(int i = 0; i < 1000; i++){
+		Heavy key(i), value(i * 2);
+		if(i % 2) Q[std::move(key)] = std::move(value);
+		else Q.insert(sjtu::pair<const Heavy, Heavy>(std::move(key), std::move(value)));
+		if(key.val != -1 || value.val != -1) return 0;
+	}
+	// the key of a value_type rvalue is const, so only that copy is left.
+	if(Heavy::copies != 500) return 0;
+	Heavy value(7);
+	if(Q.insert(sjtu::pair<const Heavy, Heavy>(Heavy(3), std::move(value))).second || Q.at(Heavy(3)).val != 6) return 0;
+	int copies = Heavy::copies;
+	sjtu::map<Heavy, Heavy, HeavyLess> P(std::move(Q));
+	if(!Q.empty() || Q.begin() != Q.end() || P.size() != 1000) return 0;
+	Q = std::move(P);
+	if(!P.empty() || Q.size() != 1000 || Q.nth(999) -> second.val != 1998) return 0;
+	Q = std::move(Q);
+	if(Q.size() != 1000) return 0;
+	P[Heavy(1)] = Heavy(1);
+	return Heavy::copies == copies && P.size() == 1;
+}
+
+bool check9(){ //--begin(), ++end() and --end() stay right through every kind of update
+	sjtu::map<int, int> Q, other;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 20000; i++){
+		int a = rand() % 3000;
+		switch(rand() % 6){
+			case 0: case 1: Q[a] = i; stdQ[a] = i; break;
+			case 2: if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); } break;
+			case 3: if(stdQ.count(a)){ other.insert(Q.extract(a)); stdQ.erase(a); } break;
+			case 4:
+				if(i % 100 == 0){
+					Q.erase(Q.lower_bound(a), Q.lower_bound(a + 300));
+					stdQ.erase(stdQ.lower_bound(a), stdQ.lower_bound(a + 300));
+				}
+				break;
+			default:
+				if(i % 500 == 0){ sjtu::map<int, int> tmp(Q); Q = tmp; }
+		}
+		if(stdQ.empty()){
+			if(Q.begin() != Q.end()) return 0;
+			try{ --Q.end(); return 0; } catch(...){}
+			continue;
+		}
+		if(Q.begin() -> first != stdQ.begin() -> first) return 0;
+		if((--Q.end()) -> first != stdQ.rbegin() -> first) return 0;
+		try{ --Q.begin(); return 0; } catch(...){}
+		try{ Q.cbegin()--; return 0; } catch(...){}
+		try{ ++Q.end(); return 0; } catch(...){}
+	}
+	Q.merge(other);
+	Q.clear();
+	try{ --Q.cend(); return 0; } catch(...){}
+	return Q.begin() == Q.end();
+}
+
+bool check10(){ //find_batch and count_batch agree with find and count
+	sjtu::map<int, int> Q;
+	const sjtu::map<int, int> &cQ = Q;
+	vector<int> keys;
+	vector<sjtu::map<int, int>::iterator> found(1000);
+	if(Q.find_batch(keys.begin(), keys.end(), found.begin()) != found.begin() || Q.count_batch(keys.begin(), keys.end())) return 0;
+	for(int i = 0; i < 1000; i++) keys.push_back(rand() % 4000);
+	if(Q.find_batch(keys.begin(), keys.end(), found.begin()) != found.end() || found[0] != Q.end()) return 0;
+	for(int i = 0; i < 20000; i++) Q[rand() % 40000] = i;
+	for(int i = 0; i < 4000; i++) keys.push_back(rand() % 40000);
+	found.resize(keys.size());
+	vector<sjtu::map<int, int>::const_iterator> cfound(keys.size());
+	Q.find_batch(keys.begin(), keys.end(), found.begin());
+	cQ.find_batch(keys.data(), keys.data() + keys.size(), cfound.begin());
+	size_t hits = 0;
+	for(size_t i = 0; i < keys.size(); i++){
+		if(found[i] != Q.find(keys[i]) || cfound[i] != cQ.find(keys[i])) return 0;
+		hits += Q.count(keys[i]);
+	}
+	return Q.count_batch(keys.begin(), keys.end()) == hits;
+}
+
+bool check11(){ //union_with, intersect_with, difference and range insert against std::map
+	for(int round = 0; round < 3; round++){
+		int n = round == 0 ? 50 : 60000 * round, range = n * 3;
+		sjtu::map<int, int> A, B;
+		std::map<int, int> stdA, stdB;
+		vector<sjtu::map<int, int>::value_type> batch;
+		if(round == 2){ A.set_parallel(true); B.set_parallel(true); }
+		for(int i = 0; i < n; i++){
+			int a = rand() % range, b = rand() % range;
+			A[a] = i; stdA[a] = i;
+			batch.push_back(sjtu::map<int, int>::value_type(b, -i));
+			stdB.insert(std::make_pair(b, -i));
+		}
+		B.insert(batch.begin(), batch.end());
+		if(B.size() != stdB.size()) return 0;
+		sjtu::map<int, int> U(A), I(A), D(A), E;
+		U.union_with(B);
+		I.intersect_with(std::move(B));
+		D.difference(U);
+		if(!B.empty() || !D.empty()) return 0;
+		D = A;
+		B.insert(batch.begin(), batch.end());
+		D.difference(B);
+		E.union_with(A);
+		std::map<int, int> stdU(stdA), stdI, stdD;
+		stdU.insert(stdB.begin(), stdB.end());
+		for(std::map<int, int>::iterator it = stdA.begin(); it != stdA.end(); ++it){
+			if(stdB.count(it -> first)) stdI.insert(*it); else stdD.insert(*it);
+		}
+		std::map<int, int> *expect[4] = {&stdU, &stdI, &stdD, &stdA};
+		sjtu::map<int, int> *got[4] = {&U, &I, &D, &E};
+		for(int k = 0; k < 4; k++){
+			if(got[k] -> size() != expect[k] -> size()) return 0;
+			size_t pos = 0;
+			for(std::map<int, int>::iterator it = expect[k] -> begin(); it != expect[k] -> end(); ++it, ++pos){
+				if(got[k] -> nth(pos) -> first != it -> first || got[k] -> nth(pos) -> second != it -> second) return 0;
+			}
+			if(!expect[k] -> empty() && (--got[k] -> end()) -> first != expect[k] -> rbegin() -> first) return 0;
+		}
+	}
+	return 1;
+}
+
+struct sum_and_span { //sum of the values, with the first and the last key to check the order
+	struct result_type{ long long sum; int first, last; bool empty; };
+	static result_type identity(){ result_type r = {0, 0, 0, true}; return r; }
+	static result_type lift(const int &key, const long long &value){ result_type r = {value, key, key, false}; return r; }
+	static result_type combine(const result_type &a, const result_type &b){
+		if(a.empty) return b;
+		if(b.empty) return a;
+		result_type r = {a.sum + b.sum, a.first, b.last, false};
+		return r;
+	}
+};
+
+bool check12(){ //aggregate over key ranges after every kind of change
+	typedef sjtu::map<int, long long, std::less<int>, sum_and_span> AggMap;
+	AggMap Q;
+	std::map<int, long long> stdQ;
+	for(int i = 1; i <= 60000; i++){
+		int a = rand() % 20000, b = rand() % 1000;
+		switch(rand() % 8){
+			case 0: Q[a] = b; stdQ[a] = b; break;
+			case 1: Q[a] += b; stdQ[a] += b; break;
+			case 2: Q.insert(AggMap::value_type(a, b)); stdQ.insert(std::make_pair(a, (long long)b)); break;
+			case 3: if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); } break;
+			case 4: if(stdQ.count(a)){ Q.find(a) -> second = b; stdQ[a] = b; } break;
+			case 5: if(stdQ.count(a)){ Q.at(a) -= b; stdQ[a] -= b; } break;
+			case 6: if(stdQ.count(a)){ AggMap::node_type nh = Q.extract(a); nh.mapped() = b; Q.insert(std::move(nh)); stdQ[a] = b; } break;
+			default: if(stdQ.count(a)){ (*Q.find(a)).second *= 2; stdQ[a] *= 2; }
+		}
+		if(i % 1000 == 0){
+			AggMap P(Q), R;
+			R = P;
+			for(int t = 0; t < 20; t++){
+				int lo = rand() % 21000 - 500, hi = lo + rand() % 5000;
+				long long sum = 0; int first = 0, last = 0; bool empty = true;
+				for(std::map<int, long long>::iterator it = stdQ.lower_bound(lo); it != stdQ.end() && it -> first < hi; ++it){
+					sum += it -> second; if(empty) first = it -> first; last = it -> first; empty = false;
+				}
+				AggMap *maps[3] = {&Q, &P, &R};
+				for(int k = 0; k < 3; k++){
+					sum_and_span::result_type r = maps[k] -> aggregate(lo, hi);
+					if(r.empty != empty || r.sum != sum || (!empty && (r.first != first || r.last != last))) return 0;
+				}
+			}
+		}
+	}
+	std::vector<AggMap::value_type> batch;
+	for(int i = 0; i < 30000; i++) batch.push_back(AggMap::value_type(20000 + rand() % 40000, i));
+	Q.insert(batch.begin(), batch.end());
+	for(size_t i = 0; i < batch.size(); i++) stdQ.insert(std::make_pair(batch[i].first, batch[i].second));
+	Q.erase(Q.lower_bound(5000), Q.lower_bound(25000));
+	stdQ.erase(stdQ.lower_bound(5000), stdQ.lower_bound(25000));
+	long long total = 0;
+	for(std::map<int, long long>::iterator it = stdQ.begin(); it != stdQ.end(); ++it) total += it -> second;
+	sum_and_span::result_type r = Q.aggregate(-1, 1 << 30);
+	return r.sum == total && r.first == stdQ.begin() -> first && r.last == stdQ.rbegin() -> first
+		&& Q.aggregate(5000, 25000).empty && Q.aggregate(7, 7).empty;
+}
+
+bool check13(){ //lazy erase: tombstones stay invisible through lookups, ranks, aggregates and copies
+	typedef sjtu::map<int, long long, std::less<int>, sum_and_span> AggMap;
+	AggMap Q;
+	std::map<int, long long> stdQ;
+	Q.set_lazy_erase(true);
+	size_t most = 0;
+	for(int i = 1; i <= 80000; i++){
+		int a = rand() % 5000;
+		switch(rand() % 8){
+			case 0: case 1: case 2: Q[a] = i; stdQ[a] = i; break;
+			case 3: Q.insert(sjtu::pair<int, long long>(a, i)); stdQ.insert(std::pair<int, long long>(a, i)); break;
+			case 4: case 5: case 6:
+				if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); }
+				break;
+			default:
+				if(i % 1000 == 0){ AggMap tmp(Q); Q = tmp; }
+				else if(i % 997 == 0){ Q.erase(Q.lower_bound(a), Q.lower_bound(a + 100)); stdQ.erase(stdQ.lower_bound(a), stdQ.lower_bound(a + 100)); }
+				else if(!stdQ.empty()){ Q.begin() -> second += 1; stdQ.begin() -> second += 1; }
+		}
+		if(Q.tombstones() > Q.size() + 1) return 0;
+		most = std::max(most, Q.tombstones());
+		if(Q.size() != stdQ.size() || Q.empty() != stdQ.empty()) return 0;
+		if(stdQ.empty()){ if(Q.begin() != Q.end()) return 0; continue; }
+		if(Q.begin() -> first != stdQ.begin() -> first || (--Q.end()) -> first != stdQ.rbegin() -> first) return 0;
+		if(i % 100 == 0){
+			if(Q.count(a) != stdQ.count(a) || Q.rank(a) != (size_t)std::distance(stdQ.begin(), stdQ.lower_bound(a))) return 0;
+			AggMap::iterator lb = Q.lower_bound(a), ub = Q.upper_bound(a);
+			std::map<int, long long>::iterator stdlb = stdQ.lower_bound(a), stdub = stdQ.upper_bound(a);
+			if((lb == Q.end()) != (stdlb == stdQ.end()) || (lb != Q.end() && lb -> first != stdlb -> first)) return 0;
+			if((ub == Q.end()) != (stdub == stdQ.end()) || (ub != Q.end() && ub -> first != stdub -> first)) return 0;
+			size_t k = rand() % stdQ.size();
+			std::map<int, long long>::iterator stdit = stdQ.begin();
+			std::advance(stdit, k);
+			if(Q.nth(k) -> first != stdit -> first || Q.nth(k) - Q.begin() != (int)k) return 0;
+			long long total = 0;
+			for(std::map<int, long long>::iterator it = stdQ.lower_bound(a); it != stdQ.lower_bound(a + 700); ++it) total += it -> second;
+			if(Q.aggregate(a, a + 700).sum != total) return 0;
+		}
+	}
+	if(most == 0) return 0;
+	AggMap::const_iterator it = Q.cbegin();
+	for(std::map<int, long long>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); ++stdit, ++it)
+		if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+	if(it != Q.cend()) return 0;
+	AggMap::iterator keep = Q.nth(Q.size() / 2);
+	int key = keep -> first;
+	Q.set_lazy_erase(false);
+	return Q.tombstones() == 0 && keep -> first == key && Q.find(key) == keep && Q.size() == stdQ.size();
+}
+
+bool check14(){ //the hot key cache never hands out an erased, moved or stale node
+	sjtu::map<int, int> Q, other;
+	std::map<int, int> stdQ;
+	Q.set_hot_cache(60);
+	if(Q.hot_cache_size() != 64) return 0;
+	for(int i = 1; i <= 200000; i++){
+		int a = rand() % 8 ? rand() % 40 : rand() % 4000; //mostly hot keys
+		switch(rand() % 12){
+			case 0: case 1: case 2: Q[a] += i; stdQ[a] += i; break;
+			case 3: if(Q.count(a) != stdQ.count(a)) return 0; break;
+			case 4: if(stdQ.count(a) && Q.at(a) != stdQ[a]) return 0; break;
+			case 5: if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); } break;
+			case 6: if(stdQ.count(a)){ other.insert(Q.extract(a)); stdQ.erase(a); } break;
+			case 7: if(i % 50 == 0){ Q.merge(other); for(sjtu::map<int, int>::iterator it = Q.begin(); it != Q.end(); ++it) stdQ.insert(std::pair<int, int>(it -> first, it -> second)); } break;
+			case 8: if(i % 300 == 0){ Q.erase(Q.lower_bound(a), Q.lower_bound(a + 20)); stdQ.erase(stdQ.lower_bound(a), stdQ.lower_bound(a + 20)); } break;
+			case 9: if(i % 1000 == 0){ sjtu::map<int, int> tmp(Q); Q = tmp; if(Q.hot_cache_size() != 64) return 0; } break;
+			case 10: if(i % 5000 == 0) Q.set_lazy_erase(!Q.lazy_erase()); break;
+			default:{
+				const sjtu::map<int, int> &C = Q;
+				sjtu::map<int, int>::const_iterator it = C.find(a);
+				if((it == C.cend()) != !stdQ.count(a) || (it != C.cend() && it -> second != stdQ[a])) return 0;
+			}
+		}
+		if(Q.size() != stdQ.size()) return 0;
+	}
+	sjtu::map<int, int>::const_iterator it = Q.cbegin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); ++stdit, ++it)
+		if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+	Q.set_hot_cache(0);
+	return it == Q.cend() && Q.hot_cache_size() == 0 && Q.at(stdQ.begin() -> first) == stdQ.begin() -> second;
+}
+
+long long comparisons = 0;
+struct counting_less {
+	bool operator () (int lhs, int rhs) const { ++comparisons; return lhs < rhs; }
+};
+
+bool check15(){ //operator[], insert and find_or_emplace descend once, and factories run only on a miss
+	sjtu::map<int, int, counting_less> Q;
+	std::map<int, int> stdQ;
+	int built = 0, misses = 0;
+	for(int i = 1; i <= 50000; i++){
+		int a = rand() % 20000;
+		comparisons = 0;
+		bool found = Q.find(a) != Q.end();
+		long long lookup = comparisons;
+		comparisons = 0;
+		switch(i % 3){
+			case 0: Q[a]++; stdQ[a]++; break;
+			case 1:
+				if(Q.insert(sjtu::pair<int, int>(a, i)).second == found) return 0;
+				stdQ.insert(std::pair<int, int>(a, i));
+				break;
+			default:{
+				sjtu::pair<sjtu::map<int, int, counting_less>::iterator, bool> r = Q.find_or_emplace(a, [&] { ++built; return -i; });
+				std::pair<std::map<int, int>::iterator, bool> stdr = stdQ.insert(std::pair<int, int>(a, -i));
+				if(r.second != stdr.second || r.first -> second != stdr.first -> second) return 0;
+				if(!r.second) break;
+				++misses;
+			}
+		}
+		if(comparisons > lookup) return 0;
+	}
+	if(built != misses || Q.size() != stdQ.size()) return 0;
+	sjtu::map<int, int, counting_less>::const_iterator it = Q.cbegin();
+	for(std::map<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); ++stdit, ++it)
+		if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+	return it == Q.cend();
+}
+
+string random_key(){ //short alphabets, shared 8-byte prefixes, NULs and bytes above 127
+	static const char alphabet[] = {'a', 'b', '\0', (char)0xff, (char)0x80};
+	string s = rand() % 2 ? "prefix12" : "";
+	int n = rand() % 11;
+	for(int i = 0; i < n; i++) s += alphabet[rand() % 5];
+	return s;
+}
+
+bool check16(){ //std::string keys against std::map, through every kind of lookup
+	sjtu::map<string, int> Q;
+	std::map<string, int> stdQ;
+	sjtu::set<string> S;
+	std::set<string> stdS;
+	for(int i = 1; i <= 60000; i++){
+		string a = random_key();
+		switch(rand() % 5){
+			case 0: case 1: Q[a] = i; stdQ[a] = i; S.insert(a); stdS.insert(a); break;
+			case 2:
+				if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); }
+				if(S.erase(a) != stdS.erase(a)) return 0;
+				break;
+			default:{
+				if(Q.count(a) != stdQ.count(a) || S.count(a) != stdS.count(a)) return 0;
+				if(Q.rank(a) != (size_t)std::distance(stdQ.begin(), stdQ.lower_bound(a))) return 0;
+				sjtu::map<string, int>::iterator lb = Q.lower_bound(a), ub = Q.upper_bound(a);
+				std::map<string, int>::iterator stdlb = stdQ.lower_bound(a), stdub = stdQ.upper_bound(a);
+				if((lb == Q.end()) != (stdlb == stdQ.end()) || (lb != Q.end() && lb -> first != stdlb -> first)) return 0;
+				if((ub == Q.end()) != (stdub == stdQ.end()) || (ub != Q.end() && ub -> first != stdub -> first)) return 0;
+			}
+		}
+		if(Q.size() != stdQ.size() || S.size() != stdS.size()) return 0;
+	}
+	sjtu::map<string, int>::const_iterator it = Q.cbegin();
+	for(std::map<string, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); ++stdit, ++it)
+		if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+	sjtu::set<string>::const_iterator sit = S.cbegin();
+	for(std::set<string>::iterator stdit = stdS.begin(); stdit != stdS.end(); ++stdit, ++sit)
+		if(*sit != *stdit) return 0;
+	return it == Q.cend() && sit == S.cend();
+}
+
+bool same_ends(sjtu::map<int, int> &Q, const std::map<int, int> &stdQ){
+	if(Q.size() != stdQ.size() || Q.empty() != stdQ.empty()) return 0;
+	if(stdQ.empty()) return Q.begin() == Q.end() && Q.cbegin() == Q.cend();
+	if(Q.begin() -> first != stdQ.begin() -> first || Q.cbegin() -> first != stdQ.begin() -> first) return 0;
+	if((--Q.end()) -> first != stdQ.rbegin() -> first || (--Q.cend()) -> first != stdQ.rbegin() -> first) return 0;
+	return Q.begin() + (int)stdQ.size() == Q.end();
+}
+
+bool check17(){ //begin() and --end() after erase(first, last) and merge take away or bring in the extremes
+	for(int lazy = 0; lazy < 2; lazy++){
+		sjtu::map<int, int> Q;
+		std::map<int, int> stdQ;
+		Q.set_lazy_erase(lazy);
+		for(int i = 0; i < 1000; i++){ Q[i] = i; stdQ[i] = i; }
+		if(lazy){ Q.erase(Q.find(0)); Q.erase(--Q.end()); stdQ.erase(0); stdQ.erase(999); }
+		if(!same_ends(Q, stdQ)) return 0;
+		Q.erase(Q.begin(), Q.find(100)); stdQ.erase(stdQ.begin(), stdQ.find(100));
+		if(!same_ends(Q, stdQ)) return 0;
+		Q.erase(Q.find(900), Q.end()); stdQ.erase(stdQ.find(900), stdQ.end());
+		if(!same_ends(Q, stdQ)) return 0;
+		Q.erase(Q.find(300), Q.find(600)); stdQ.erase(stdQ.find(300), stdQ.find(600));
+		if(!same_ends(Q, stdQ)) return 0;
+		Q.erase(Q.begin(), Q.begin() + 1); stdQ.erase(stdQ.begin());
+		Q.erase(--Q.end(), Q.end()); stdQ.erase(--stdQ.end());
+		if(!same_ends(Q, stdQ)) return 0;
+
+		sjtu::map<int, int> S;
+		std::map<int, int> stdS;
+		S.set_lazy_erase(lazy);
+		for(int k = -50; k < 1100; k += 7){ S[k] = -k; stdS[k] = -k; }
+		if(lazy){ S.erase(S.find(-50)); stdS.erase(-50); }
+		Q.merge(S);
+		for(std::map<int, int>::iterator it = stdS.begin(); it != stdS.end(); )
+			if(stdQ.insert(*it).second) stdS.erase(it++); else ++it;
+		if(!same_ends(Q, stdQ) || !same_ends(S, stdS)) return 0;
+
+		Q.erase(Q.begin(), Q.end()); stdQ.clear();
+		if(!same_ends(Q, stdQ)) return 0;
+		Q.merge(S);
+		stdQ.swap(stdS);
+		if(!same_ends(Q, stdQ) || !same_ends(S, stdS)) return 0;
+		Q.erase(Q.begin() + 1, --Q.end());
+		if(Q.size() != 2 || Q.begin() -> first != stdQ.begin() -> first || (--Q.end()) -> first != stdQ.rbegin() -> first) return 0;
+	}
+	return 1;
+}
+
+std::atomic<int> live_values(0);
+std::atomic<long> compare_budget(-1);
+struct counted { //an element that counts its live copies, safely from several threads
+	int v;
+	counted(int v = 0) : v(v) { live_values++; }
+	counted(const counted &rhs) : v(rhs.v) { live_values++; }
+	counted & operator = (const counted &rhs) { v = rhs.v; return *this; }
+	~counted() { live_values--; }
+};
+struct budget_less { //throws once compare_budget runs out
+	bool operator () (int a, int b) const {
+		if(compare_budget.fetch_sub(1) == 0) throw 0;
+		return a < b;
+	}
+};
+
+bool check18(){ //a comparator throwing during a set operation, forked or not, leaves both maps empty
+	typedef sjtu::map<int, counted, budget_less> CMap;
+	for(int parallel = 0; parallel < 2; parallel++){
+		for(int op = 0; op < 4; op++){
+			for(long budget = 10; budget < 2000000; budget *= 25){
+				{
+					CMap A, B;
+					A.set_parallel(parallel); B.set_parallel(parallel);
+					vector<sjtu::pair<const int, counted> > batch;
+					for(int i = 0; i < 40000; i++){
+						A[rand() % 120000] = counted(i);
+						batch.push_back(sjtu::pair<const int, counted>(rand() % 120000, counted(-i)));
+					}
+					if(op != 3) B.insert(batch.begin(), batch.end());
+					compare_budget = budget;
+					bool thrown = false;
+					try{
+						switch(op){
+							case 0: A.union_with(std::move(B)); break;
+							case 1: A.intersect_with(std::move(B)); break;
+							case 2: A.difference(std::move(B)); break;
+							default: A.insert(batch.begin(), batch.end());
+						}
+					} catch(int){ thrown = true; }
+					compare_budget = -1;
+					if(thrown && op != 3 && (!A.empty() || A.begin() != A.end() || !B.empty())) return 0;
+					if(!thrown && budget < 1000) return 0;
+					A[5] = counted(5);
+					if(A.at(5).v != 5) return 0;
+				}
+				if(live_values != 0) return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+int copy_budget = -1;
+struct brittle { //a value whose copy throws once copy_budget runs out
+	int v;
+	brittle(int v = 0) : v(v) {}
+	brittle(const brittle &rhs) : v(rhs.v) { if(copy_budget >= 0 && copy_budget-- == 0) throw 0; }
+	brittle & operator = (const brittle &rhs) { v = rhs.v; return *this; }
+};
+
+bool check19(){ //a value copy throwing in the middle of an assignment leaves no stale hot cache entries
+	sjtu::map<int, brittle> a, b;
+	for(int i = 0; i < 200; i++){ a[i] = brittle(i); b[i + 1000] = brittle(-i); }
+	a.set_hot_cache(64);
+	for(int i = 0; i < 200; i++) if(a.at(i).v != i) return 0;
+	copy_budget = 49;
+	bool thrown = false;
+	try{ a = b; } catch(int){ thrown = true; }
+	copy_budget = -1;
+	if(!thrown || a.size() != 0 || a.begin() != a.end()) return 0;
+	for(int i = 0; i < 200; i++) if(a.count(i) || a.find(i) != a.end()) return 0;
+	a[7] = brittle(7);
+	if(a.at(7).v != 7 || a.size() != 1) return 0;
+	a = b;
+	return a.size() == 200 && a.at(1005).v == -5 && !a.count(7);
+}
+bool check20(){ //a reference kept across aggregate() is seen again once the value is fetched anew
+	typedef sjtu::map<int, long long, std::less<int>, sum_and_span> AggMap;
+	AggMap Q;
+	for(int i = 0; i < 100; i++) Q[i] = 1;
+	long long &r = Q[50];
+	if(Q.aggregate(0, 100).sum != 100) return 0;
+	r = 1000;
+	Q.at(50);
+	if(Q.aggregate(0, 100).sum != 1099) return 0;
+	AggMap::iterator it = Q.find(20);
+	if(Q.aggregate(0, 50).sum != 50) return 0;
+	it -> second = 5;
+	if(Q.aggregate(0, 50).sum != 54) return 0;
+	(*it).second += 5;
+	r = 0;
+	Q[50];
+	return Q.aggregate(0, 100).sum == 108 && Q.aggregate(20, 21).sum == 10;
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+	if(!check4()) cout << "Test 4 Failed..." << endl; else cout << "Test 4 Passed!" << endl;
+	if(!check5()) cout << "Test 5 Failed..." << endl; else cout << "Test 5 Passed!" << endl;
+	if(!check6()) cout << "Test 6 Failed..." << endl; else cout << "Test 6 Passed!" << endl;
+	if(!check7()) cout << "Test 7 Failed..." << endl; else cout << "Test 7 Passed!" << endl;
+	if(!check8()) cout << "Test 8 Failed..." << endl; else cout << "Test 8 Passed!" << endl;
+	if(!check9()) cout << "Test 9 Failed..." << endl; else cout << "Test 9 Passed!" << endl;
+	if(!check10()) cout << "Test 10 Failed..." << endl; else cout << "Test 10 Passed!" << endl;
+	if(!check11()) cout << "Test 11 Failed..." << endl; else cout << "Test 11 Passed!" << endl;
+	if(!check12()) cout << "Test 12 Failed..." << endl; else cout << "Test 12 Passed!" << endl;
+	if(!check13()) cout << "Test 13 Failed..." << endl; else cout << "Test 13 Passed!" << endl;
+	if(!check14()) cout << "Test 14 Failed..." << endl; else cout << "Test 14 Passed!" << endl;
+	if(!check15()) cout << "Test 15 Failed..." << endl; else cout << "Test 15 Passed!" << endl;
+	if(!check16()) cout << "Test 16 Failed..." << endl; else cout << "Test 16 Passed!" << endl;
+	if(!check17()) cout << "Test 17 Failed..." << endl; else cout << "Test 17 Passed!" << endl;
+	if(!check18()) cout << "Test 18 Failed..." << endl; else cout << "Test 18 Passed!" << endl;
+	if(!check19()) cout << "Test 19 Failed..." << endl; else cout << "Test 19 Passed!" << endl;
+	if(!check20()) cout << "Test 20 Failed..." << endl; else cout << "Test 20 Passed!" << endl;
+
+	return 0;
+}
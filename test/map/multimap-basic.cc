@@ -0,0 +1,88 @@
+// Checks for sjtu::multimap against std::multimap
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdlib>
+#include "multimap.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+bool check1(){ //equal keys keep their insertion order, as in std::multimap
+	sjtu::multimap<int, int> Q;
+	std::multimap<int, int> stdQ;
+	for(int i = 1; i <= 60000; i++){
+		int a = rand() % 1000;
+		if(rand() % 4){
+			sjtu::multimap<int, int>::iterator it = Q.insert(sjtu::pair<int, int>(a, i));
+			stdQ.insert(std::pair<int, int>(a, i));
+			if(it -> first != a || it -> second != i) return 0;
+		}
+		else if(rand() % 8 == 0){ if(Q.erase(a) != stdQ.erase(a)) return 0; }
+		else if(Q.count(a)){
+			Q.erase(Q.find(a));
+			stdQ.erase(stdQ.find(a));
+		}
+		if(Q.size() != stdQ.size()) return 0;
+	}
+	sjtu::multimap<int, int>::const_iterator it = Q.cbegin();
+	for(std::multimap<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+	}
+	return it == Q.cend();
+}
+
+bool check2(){ //count, bounds and equal_range, values changed through iterators
+	sjtu::multimap<int, int> Q;
+	std::multimap<int, int> stdQ;
+	for(int i = 1; i <= 30000; i++){
+		int a = rand() % 300;
+		Q.insert(sjtu::pair<int, int>(a, i));
+		stdQ.insert(std::pair<int, int>(a, i));
+	}
+	for(sjtu::multimap<int, int>::iterator it = Q.begin(); it != Q.end(); it++) it -> second *= 2;
+	for(std::multimap<int, int>::iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++) stdit -> second *= 2;
+	const sjtu::multimap<int, int> &C = Q;
+	for(int a = -1; a <= 300; a++){
+		if(C.count(a) != stdQ.count(a)) return 0;
+		sjtu::pair<sjtu::multimap<int, int>::const_iterator, sjtu::multimap<int, int>::const_iterator> r = C.equal_range(a);
+		std::pair<std::multimap<int, int>::iterator, std::multimap<int, int>::iterator> stdr = stdQ.equal_range(a);
+		for(; stdr.first != stdr.second; stdr.first++, r.first++){
+			if(r.first == r.second || r.first -> second != stdr.first -> second) return 0;
+		}
+		if(r.first != r.second) return 0;
+		if(C.upper_bound(a) != r.second) return 0;
+		if(stdQ.count(a) && C.find(a) -> second != stdQ.find(a) -> second) return 0;
+	}
+	return 1;
+}
+
+bool check3(){ //keys without assignment, copies and errors
+	{
+		sjtu::multimap<Integer, string, Compare> Q;
+		for(int i = 0; i < 3000; i++) Q.insert(sjtu::pair<Integer, string>(Integer(i % 1000), "x"));
+		sjtu::multimap<Integer, string, Compare> R(Q), S;
+		S = R;
+		Q.clear();
+		if(S.size() != 3000 || S.count(Integer(7)) != 3 || !Q.empty() || Q.begin() != Q.end()) return 0;
+		int cnt = 0;
+		try{ S.erase(S.end()); } catch(...){ cnt++; }
+		try{ S.erase(R.begin()); } catch(...){ cnt++; }
+		try{ ++S.end(); } catch(...){ cnt++; }
+		try{ S.begin()--; } catch(...){ cnt++; }
+		try{ *S.find(Integer(1000)); } catch(...){ cnt++; }
+		if(cnt != 5) return 0;
+		if(S.erase(Integer(7)) != 3 || S.count(Integer(7)) != 0 || S.size() != 2997) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+int main(){
+	srand(20171105);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+// Checks for sjtu::persistent_map: old versions must survive every change
+
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "persistent_map.hpp"
+
+using namespace std;
+
+typedef sjtu::persistent_map<int, int> PMap;
+
+bool same(const PMap &Q, const std::map<int, int> &stdQ){
+	if(Q.size() != stdQ.size()) return 0;
+	PMap::const_iterator it = Q.cbegin();
+	for(std::map<int, int>::const_iterator stdit = stdQ.begin(); stdit != stdQ.end(); stdit++, it++){
+		if(it -> first != stdit -> first || (*it).second != stdit -> second) return 0;
+	}
+	return it == Q.cend();
+}
+
+bool check1(){ //insert keeps old versions
+	vector<PMap> versions(1);
+	vector<std::map<int, int> > stdVersions(1);
+	for(int i = 1; i <= 3000; i++){
+		int a = rand() % 5000;
+		versions.push_back(versions.back().insert(PMap::value_type(a, i)));
+		stdVersions.push_back(stdVersions.back());
+		stdVersions.back().insert(std::map<int, int>::value_type(a, i));
+	}
+	for(int i = 0; i < (int)versions.size(); i += 97){
+		if(!same(versions[i], stdVersions[i])) return 0;
+	}
+	return same(versions.back(), stdVersions.back());
+}
+
+bool check2(){ //erase keeps old versions
+	PMap Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 5000; i++){
+		int a = rand() % 10000;
+		Q = Q.insert(PMap::value_type(a, i));
+		stdQ.insert(std::map<int, int>::value_type(a, i));
+	}
+	PMap old(Q);
+	std::map<int, int> stdOld(stdQ);
+	for(int i = 1; i <= 5000; i++){
+		int a = rand() % 10000;
+		Q = Q.erase(a);
+		stdQ.erase(a);
+		if(Q.size() != stdQ.size()) return 0;
+	}
+	return same(Q, stdQ) && same(old, stdOld);
+}
+
+bool check3(){ //find, count, at
+	PMap Q;
+	for(int i = 0; i < 1000; i++) Q = Q.insert(PMap::value_type(i * 2, i));
+	const PMap P = Q.erase(10);
+	if(Q.count(10) != 1 || P.count(10) != 0) return 0;
+	if(Q.at(10) != 5 || Q.find(10) -> second != 5) return 0;
+	if(P.find(10) != P.cend() || P.find(12) -> second != 6) return 0;
+	int cnt = 0;
+	try{ P.at(10); } catch(...){ cnt++; }
+	try{ P.cend()++; } catch(...){ cnt++; }
+	try{ --P.cbegin(); } catch(...){ cnt++; }
+	return cnt == 3;
+}
+
+bool check4(){ //iterators walk both ways from anywhere and outlive the version they belong to
+	std::map<int, int> stdQ;
+	PMap::const_iterator first, mid, last;
+	{
+		PMap Q;
+		for(int i = 0; i < 20000; i++){
+			int a = rand() % 50000;
+			Q = Q.insert(PMap::value_type(a, i));
+			stdQ.insert(std::make_pair(a, i));
+		}
+		first = Q.cbegin();
+		mid = Q.find(stdQ.begin() -> first);
+		for(int i = 0; i < 1000; i++) ++mid;
+		last = Q.cend();
+		std::map<int, int>::reverse_iterator stdit = stdQ.rbegin();
+		for(PMap::const_iterator it = Q.cend(); it != Q.cbegin(); ++stdit){
+			--it;
+			if(it -> first != stdit -> first || it -> second != stdit -> second) return 0;
+		}
+		for(int k = 0; k < 200; k++){
+			std::map<int, int>::iterator at = stdQ.lower_bound(rand() % 50000);
+			if(at == stdQ.end()) continue;
+			PMap::const_iterator it = Q.find(at -> first), back = it;
+			std::map<int, int>::iterator stdback = at;
+			for(int i = 0; i < 20 && at != stdQ.end(); i++, ++at, it++){
+				if(it == Q.cend() || it -> first != at -> first) return 0;
+			}
+			if(at == stdQ.end() && it != Q.cend()) return 0;
+			for(int i = 0; i < 20 && stdback != stdQ.begin(); i++){
+				--stdback; back--;
+				if(back -> first != stdback -> first) return 0;
+			}
+		}
+	}
+	//every version is gone: the iterators keep their tree alive.
+	std::map<int, int>::iterator stdit = stdQ.begin();
+	PMap::const_iterator it = first;
+	for(; it != last; ++it, ++stdit){
+		if(stdit == stdQ.end() || it -> first != stdit -> first) return 0;
+	}
+	if(stdit != stdQ.end()) return 0;
+	if((--it) -> first != stdQ.rbegin() -> first) return 0;
+	stdit = stdQ.begin();
+	for(int i = 0; i < 1000; i++) ++stdit;
+	if(mid -> first != stdit -> first) return 0;
+	int cnt = 0;
+	try{ --first; } catch(...){ cnt++; }
+	try{ ++last; } catch(...){ cnt++; }
+	if(first -> first != stdQ.begin() -> first) return 0;
+	PMap E;
+	try{ --E.cend(); } catch(...){ cnt++; }
+	return cnt == 3 && E.cbegin() == E.cend();
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+	if(!check4()) cout << "Test 4 Failed..." << endl; else cout << "Test 4 Passed!" << endl;
+
+	return 0;
+}
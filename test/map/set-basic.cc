@@ -0,0 +1,104 @@
+// Checks for sjtu::set and sjtu::multiset against std::set and std::multiset
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <cstdlib>
+#include "set.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+bool check1(){ //set: insert, erase, find and bounds against std::set
+	sjtu::set<int> S;
+	std::set<int> stdS;
+	for(int i = 1; i <= 60000; i++){
+		int a = rand() % 20000;
+		if(rand() % 3){
+			sjtu::pair<sjtu::set<int>::iterator, bool> r = S.insert(a);
+			bool fresh = stdS.insert(a).second;
+			if(r.second != fresh || *r.first != a) return 0;
+		}
+		else if(S.erase(a) != stdS.erase(a)) return 0;
+		if(S.size() != stdS.size()) return 0;
+	}
+	for(int a = -1; a <= 20000; a++){
+		if(S.count(a) != stdS.count(a)) return 0;
+		sjtu::set<int>::iterator it = S.lower_bound(a), jt = S.upper_bound(a);
+		std::set<int>::iterator stdit = stdS.lower_bound(a), stdjt = stdS.upper_bound(a);
+		if((it == S.end()) != (stdit == stdS.end()) || (it != S.end() && *it != *stdit)) return 0;
+		if((jt == S.end()) != (stdjt == stdS.end()) || (jt != S.end() && *jt != *stdjt)) return 0;
+		if(S.count(a) && *S.find(a) != a) return 0;
+	}
+	sjtu::set<int>::const_iterator it = S.cbegin();
+	for(std::set<int>::iterator stdit = stdS.begin(); stdit != stdS.end(); stdit++, it++){
+		if(*it != *stdit) return 0;
+	}
+	return it == S.cend();
+}
+
+bool check2(){ //multiset: duplicates, count, equal_range and erase by key
+	sjtu::multiset<int> S;
+	std::multiset<int> stdS;
+	for(int i = 1; i <= 60000; i++){
+		int a = rand() % 500;
+		if(rand() % 4){ S.insert(a); stdS.insert(a); }
+		else if(rand() % 8 == 0){ if(S.erase(a) != stdS.erase(a)) return 0; }
+		else if(S.count(a)){
+			S.erase(S.find(a));
+			stdS.erase(stdS.find(a));
+		}
+		if(S.size() != stdS.size()) return 0;
+	}
+	for(int a = -1; a <= 500; a++){
+		if(S.count(a) != stdS.count(a)) return 0;
+		sjtu::pair<sjtu::multiset<int>::iterator, sjtu::multiset<int>::iterator> r = S.equal_range(a);
+		size_t n = 0;
+		for(sjtu::multiset<int>::iterator it = r.first; it != r.second; it++, n++){
+			if(*it != a) return 0;
+		}
+		if(n != stdS.count(a)) return 0;
+		if(n == 0 && S.find(a) != S.end()) return 0;
+	}
+	sjtu::multiset<int>::const_iterator it = S.cend();
+	for(std::multiset<int>::reverse_iterator stdit = stdS.rbegin(); stdit != stdS.rend(); stdit++){
+		--it;
+		if(*it != *stdit) return 0;
+	}
+	return it == S.cbegin();
+}
+
+bool check3(){ //keys without assignment, copies and errors
+	{
+		sjtu::set<Integer, Compare> S;
+		sjtu::multiset<Integer, Compare> M;
+		for(int i = 0; i < 3000; i++){
+			S.insert(Integer(i % 1000));
+			M.insert(Integer(i % 1000));
+		}
+		sjtu::set<Integer, Compare> T(S), U;
+		sjtu::multiset<Integer, Compare> N(M), O;
+		U = T; O = N;
+		S.clear(); M.clear();
+		if(U.size() != 1000 || O.size() != 3000 || O.count(Integer(7)) != 3 || U.count(Integer(7)) != 1) return 0;
+		if(S.size() != 0 || !S.empty() || S.begin() != S.end()) return 0;
+		int cnt = 0;
+		try{ U.erase(U.end()); } catch(...){ cnt++; }
+		try{ U.erase(T.begin()); } catch(...){ cnt++; }
+		try{ ++O.end(); } catch(...){ cnt++; }
+		try{ O.begin()--; } catch(...){ cnt++; }
+		try{ *U.find(Integer(1000)); } catch(...){ cnt++; }
+		if(cnt != 5) return 0;
+		if(O.erase(Integer(7)) != 3 || O.count(Integer(7)) != 0 || O.size() != 2997) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+int main(){
+	srand(20171104);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Checks for sjtu::unordered_map against std::map
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "unordered_map.hpp"
+#include "class-counted-integer.hpp"
+
+using namespace std;
+
+struct Equal {
+	bool operator () (const Integer &lhs, const Integer &rhs) const { return lhs.val == rhs.val; }
+};
+struct Hash {
+	size_t operator () (const Integer &x) const { return x.val; }
+};
+// every key lands in the same bucket.
+struct BadHash {
+	size_t operator () (const Integer &) const { return 42; }
+};
+
+bool check1(){ //operator[], insert, erase, find against std::map
+	sjtu::unordered_map<int, int> Q;
+	std::map<int, int> stdQ;
+	for(int i = 1; i <= 200000; i++){
+		int a = rand() % 20000, b = rand();
+		switch(rand() % 4){
+			case 0: Q[a] = b; stdQ[a] = b; break;
+			case 1:
+				if(Q.insert(sjtu::unordered_map<int, int>::value_type(a, b)).second != stdQ.insert(std::map<int, int>::value_type(a, b)).second) return 0;
+				break;
+			case 2:
+				if(stdQ.count(a)){ Q.erase(Q.find(a)); stdQ.erase(a); }
+				else if(Q.find(a) != Q.end()) return 0;
+				break;
+			default:
+				if(Q.count(a) != stdQ.count(a)) return 0;
+		}
+	}
+	if(Q.size() != stdQ.size()) return 0;
+	size_t n = 0;
+	for(sjtu::unordered_map<int, int>::const_iterator it = Q.cbegin(); it != Q.cend(); ++it, ++n){
+		if(!stdQ.count(it -> first) || stdQ[it -> first] != (*it).second) return 0;
+	}
+	return n == stdQ.size();
+}
+
+bool check2(){ //references survive growth, clear keeps the table
+	sjtu::unordered_map<int, string> Q;
+	string &first = Q[-1];
+	first = "first";
+	for(int i = 0; i < 100000; i++) Q[i * 1024] = "x";
+	if(Q.at(-1) != "first" || &first != &Q.at(-1)) return 0;
+	if(Q.bucket_count() / 8 * 7 < Q.size()) return 0;
+	size_t buckets = Q.bucket_count();
+	Q.clear();
+	if(!Q.empty() || Q.bucket_count() != buckets || Q.begin() != Q.end()) return 0;
+	Q.reserve(1000);
+	return Q.bucket_count() == buckets;
+}
+
+bool check3(){ //keys without assignment, a hash that collides everywhere, copies, errors
+	{
+		sjtu::unordered_map<Integer, string, BadHash, Equal> B;
+		for(int i = 0; i < 600; i++) B[Integer(i)] = "b";
+		for(int i = 0; i < 600; i += 3) B.erase(B.find(Integer(i)));
+		for(int i = 0; i < 600; i++) if(B.count(Integer(i)) != (i % 3 != 0)) return 0;
+
+		sjtu::unordered_map<Integer, string, Hash, Equal> Q;
+		for(int i = 0; i < 3000; i++) Q[Integer((i * 7) % 3001)] = "x";
+		sjtu::unordered_map<Integer, string, Hash, Equal> P(Q), R;
+		R = P;
+		Q.clear();
+		if(P.size() != 3000 || R.size() != 3000 || !Q.empty()) return 0;
+		int cnt = 0;
+		try{ R.at(Integer(-1)); } catch(...){ cnt++; }
+		try{ ++R.end(); } catch(...){ cnt++; }
+		try{ *R.find(Integer(3001)); } catch(...){ cnt++; }
+		try{ R.erase(P.begin()); } catch(...){ cnt++; }
+		try{ R.erase(R.end()); } catch(...){ cnt++; }
+		try{ const sjtu::unordered_map<Integer, string, Hash, Equal> &C = R; C[Integer(-1)]; } catch(...){ cnt++; }
+		if(cnt != 6) return 0;
+	}
+	return Integer::counter == 0;
+}
+
+int main(){
+	srand(20171103);
+	if(!check1()) cout << "Test 1 Failed..." << endl; else cout << "Test 1 Passed!" << endl;
+	if(!check2()) cout << "Test 2 Failed..." << endl; else cout << "Test 2 Passed!" << endl;
+	if(!check3()) cout << "Test 3 Failed..." << endl; else cout << "Test 3 Passed!" << endl;
+
+	return 0;
+}